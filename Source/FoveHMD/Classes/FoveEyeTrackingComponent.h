@@ -0,0 +1,68 @@
+#pragma once
+
+/*
+* Scene component which follows one of the user's eyes, similar to how MotionControllerComponent follows a motion controller
+* Attach one of these for each eye to the camera component that follows the HMD.
+* The relative location is set to the position of the eye (taken from the headset's eye to head transform),
+* and the relative rotation is set so that the X axis points along the eye's gaze.
+* Anything attached to it (eg. a gaze cursor) will follow the eye, and is moved again on the render thread just before rendering
+*/
+
+#include "Components/SceneComponent.h"
+#include "FoveEyeTrackingComponent.generated.h"
+
+UENUM(BlueprintType)
+enum class EFoveEye : uint8
+{
+	Left,
+	Right,
+};
+
+UENUM(BlueprintType)
+enum class EFoveEyeStateChange : uint8
+{
+	BlinkStarted,     // The eye closed
+	BlinkEnded,       // The eye opened again
+	TrackingLost,     // The eye tracker lost the eye
+	TrackingAcquired, // The eye tracker found the eye again
+};
+
+// Called when the eye followed by a UFoveEyeTrackingComponent changes state
+// For BlinkEnded and TrackingAcquired, Duration is how long the eye was closed or lost for, in seconds. It is zero otherwise
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFoveEyeStateChangedSignature, EFoveEyeStateChange, Change, float, Duration);
+
+UCLASS(ClassGroup = FoveVR, meta = (BlueprintSpawnableComponent))
+class UFoveEyeTrackingComponent : public USceneComponent
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+
+	// Which eye this component follows
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FoveVR")
+		EFoveEye Eye;
+
+	// If true, the gaze is taken from the built-in gaze filter (see fove.GazeFilter) rather than the raw eye tracking data
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FoveVR")
+		bool bUseFilteredGaze;
+
+	// If true, this component and anything attached to it are moved to the latest eye tracking sample on the render thread just before rendering
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FoveVR")
+		bool bLateUpdate;
+
+	// True if the eye was tracked and open the last time this component was updated
+	// The component keeps its last transform while this is false
+	UPROPERTY(BlueprintReadOnly, Category = "FoveVR")
+		bool bIsTracked;
+
+	// Fired at the start of the frame for each blink and tracking change of this component's eye since the last frame
+	// These are detected from every eye tracking sample, so even blinks shorter than a frame are reported
+	UPROPERTY(BlueprintAssignable, Category = "FoveVR")
+		FFoveEyeStateChangedSignature OnEyeStateChanged;
+
+public: // UActorComponent interface
+
+	void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	void OnRegister() override;
+	void OnUnregister() override;
+};
@@ -9,6 +9,8 @@
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "FoveVRFunctionLibrary.generated.h"
 
+class UTextureRenderTarget2D;
+
 UCLASS()
 class UFoveVRFunctionLibrary : public UBlueprintFunctionLibrary
 {
@@ -34,6 +36,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FoveVR")
 		static bool GetGazeVector(bool bRelativeToHMD, FVector& outLeft, FVector& outRight);
 
+	UFUNCTION(BlueprintCallable, Category = "FoveVR")
+		static bool GetRawGazeConvergence(bool bRelativeToHMD, FVector& outRayOrigin, FVector& outRayDirection, float& outDistance, float& outAccuracy);
+
+	UFUNCTION(BlueprintCallable, Category = "FoveVR")
+		static bool GetRawGazeVector(bool bRelativeToHMD, FVector& outLeft, FVector& outRight);
+
 	UFUNCTION(BlueprintCallable, Category = "FoveVR")
 		static bool GetGazeVector2D(FVector2D& outLeft, FVector2D& outRight);
 
@@ -48,4 +56,13 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "FoveVR")
 		static bool IsPositionReady();
+
+	UFUNCTION(BlueprintCallable, Category = "FoveVR")
+		static int32 CreateOverlayLayer(bool bFixedToHMD = true);
+
+	UFUNCTION(BlueprintCallable, Category = "FoveVR")
+		static bool SetOverlayLayerTexture(int32 OverlayId, UTextureRenderTarget2D* RenderTarget, FVector2D LeftMin = FVector2D(0.0f, 0.0f), FVector2D LeftMax = FVector2D(1.0f, 1.0f), FVector2D RightMin = FVector2D(0.0f, 0.0f), FVector2D RightMax = FVector2D(1.0f, 1.0f));
+
+	UFUNCTION(BlueprintCallable, Category = "FoveVR")
+		static bool GetFoveationInset(bool bRightEye, FVector2D& outMin, FVector2D& outMax);
 };
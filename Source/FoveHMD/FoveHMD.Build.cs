@@ -46,7 +46,11 @@ public class FoveHMD : ModuleRules
             PrivateDependencyModuleNames.Add("UnrealEd");
 
         // On windows, we use the D3D11 rendering interface
+        // The loading layer also creates a D3D11 device of its own, so link against D3D11 and DXGI directly
         if (Target.Platform == UnrealTargetPlatform.Win64)
+        {
              PrivateDependencyModuleNames.Add("D3D11RHI");
+             AddEngineThirdPartyPrivateStaticDependencies(Target, "DX11");
+        }
     }
 }
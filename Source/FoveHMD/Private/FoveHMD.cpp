@@ -1,7 +1,9 @@
 #include "FoveHMD.h"
 #include "FoveHMDPrivatePCH.h"
+#include "Async/Async.h"
 #include "Core.h"
 #include "Engine.h"
+#include "FoveEyeTrackingComponent.h"
 #include "FoveVRFunctionLibrary.h"
 #include "IFVRCompositor.h"
 #include "IFVRHeadset.h"
@@ -50,6 +52,551 @@ DEFINE_LOG_CATEGORY_STATIC(LogHMD, Log, All);
 
 #define LOCTEXT_NAMESPACE "FFoveHMD"
 
+//---------------------------------------------------
+// Console variables
+//---------------------------------------------------
+
+static TAutoConsoleVariable<float> CVarFoveGazePollInterval(
+	TEXT("fove.GazePollInterval"),
+	2.0f,
+	TEXT("Interval in milliseconds at which the background gaze sampler polls the FOVE eye tracker"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFoveGazeFilter(
+	TEXT("fove.GazeFilter"),
+	0,
+	TEXT("Enables the built-in gaze filter, which is applied once per eye tracking sample.\n")
+	TEXT(" 0: GetGazeVector and GetGazeConvergence return unfiltered data (default)\n")
+	TEXT(" 1: GetGazeVector and GetGazeConvergence return data smoothed by an adaptive One Euro filter"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveGazeFilterMinCutoff(
+	TEXT("fove.GazeFilter.MinCutoff"),
+	1.0f,
+	TEXT("Cutoff frequency in Hz of the gaze filter while the gaze is still. Lower values remove more jitter during fixations"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveGazeFilterBeta(
+	TEXT("fove.GazeFilter.Beta"),
+	5.0f,
+	TEXT("How quickly the gaze filter cutoff rises with gaze speed (in radians per second). Higher values reduce lag during saccades"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveGazeFilterDerivativeCutoff(
+	TEXT("fove.GazeFilter.DerivativeCutoff"),
+	1.0f,
+	TEXT("Cutoff frequency in Hz used when smoothing the gaze speed that drives the gaze filter"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveSaccadeVelocity(
+	TEXT("fove.GazeClassifier.SaccadeVelocity"),
+	50.0f,
+	TEXT("Angular gaze velocity in degrees per second above which the gaze classifier labels samples as part of a saccade"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveMinFixationDuration(
+	TEXT("fove.GazeClassifier.MinFixationDuration"),
+	100.0f,
+	TEXT("Shortest fixation in milliseconds that the gaze classifier will report. Shorter ones are treated as noise"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFoveDynamicResolution(
+	TEXT("fove.DynamicResolution"),
+	0,
+	TEXT("Enables the dynamic resolution controller, which scales each eye's image every frame to keep GPU time within the compositor's frame budget.\n")
+	TEXT(" 0: Disabled (default)\n")
+	TEXT(" 1: Enabled"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveDynamicResolutionMinScale(
+	TEXT("fove.DynamicResolution.MinScale"),
+	0.5f,
+	TEXT("Lowest per-eye render scale, in each dimension, that the dynamic resolution controller will go to"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveDynamicResolutionTargetUtilization(
+	TEXT("fove.DynamicResolution.TargetUtilization"),
+	0.85f,
+	TEXT("Fraction of the compositor frame budget that the dynamic resolution controller aims to spend on the GPU"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveDynamicResolutionFrameBudget(
+	TEXT("fove.DynamicResolution.FrameBudget"),
+	0.0f,
+	TEXT("Compositor frame budget in milliseconds used by the dynamic resolution controller, or 0 to measure it from the frame pacing (default)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFoveFoveation(
+	TEXT("fove.Foveation"),
+	0,
+	TEXT("Enables gaze-contingent foveated rendering, where each eye is rendered as a reduced resolution periphery plus a full resolution inset around the gaze point.\n")
+	TEXT("Not available with instanced stereo or the monoscopic far field, or before Unreal 4.15.\n")
+	TEXT(" 0: Disabled (default)\n")
+	TEXT(" 1: Enabled"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveFoveationInsetSize(
+	TEXT("fove.Foveation.InsetSize"),
+	0.4f,
+	TEXT("Size of the full resolution inset around the gaze point, as a fraction of each eye's image in each dimension"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveFoveationPeripheryScale(
+	TEXT("fove.Foveation.PeripheryScale"),
+	0.5f,
+	TEXT("Resolution scale of the periphery, in each dimension. This is multiplied with the dynamic resolution scale, and kept below 1 - fove.Foveation.InsetSize"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFovePacingMode(
+	TEXT("fove.PacingMode"),
+	0,
+	TEXT("Where the render thread waits for the FOVE compositor to be ready for the next frame.\n")
+	TEXT(" 0: Wait before rendering, and render with the pose returned by the wait (default)\n")
+	TEXT(" 1: Render straight away with the last pose handed out by the compositor, and wait just before submitting the frame.\n")
+	TEXT("    Render thread work overlaps with the wait, at the cost of rendering with a pose that is older (but predicted further ahead)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFoveSwapChainDepth(
+	TEXT("fove.SwapChainDepth"),
+	2,
+	TEXT("Number of textures the rendering bridge cycles through when handing frames to the FOVE compositor.\n")
+	TEXT(" 1: Submit the viewport render target itself, so the next frame can't be rendered until the compositor is done reading it\n")
+	TEXT(" 2-3: Copy each frame into the next texture of a private swap chain and submit that, so rendering and compositing overlap (default 2)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFoveLoadingLayer(
+	TEXT("fove.LoadingLayer"),
+	0,
+	TEXT("Whether to keep the FOVE compositor fed while normal rendering is stalled, such as during LoadMap or a streaming hitch.\n")
+	TEXT(" 0: Off. The compositor is left with nothing new to show until rendering resumes (default)\n")
+	TEXT(" 1: A watchdog thread notices the stall and submits a loading scene at the compositor's frame rate, with its own D3D11 device and\n")
+	TEXT("    compositor layer so it never waits on the render thread. The scene is a sky gradient with an activity bar fixed in the world"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveLoadingLayerTimeout(
+	TEXT("fove.LoadingLayer.Timeout"),
+	50.0f,
+	TEXT("Milliseconds without a rendered frame before the loading layer takes over submitting to the compositor, see fove.LoadingLayer"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFoveMirrorMode(
+	TEXT("fove.MirrorMode"),
+	2,
+	TEXT("How the headset image is mirrored to the desktop window.\n")
+	TEXT(" 0: No mirroring. The window is not presented at all, so it costs no GPU time\n")
+	TEXT(" 1: A crop of the center of the left eye\n")
+	TEXT(" 2: Both eyes side by side (default)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFoveMirrorInterval(
+	TEXT("fove.MirrorInterval"),
+	1,
+	TEXT("Mirror to the desktop window every Nth frame sent to the headset (default 1, every frame).\n")
+	TEXT("The window is not presented on the frames in between, so it keeps showing the last mirrored frame"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveMirrorScale(
+	TEXT("fove.MirrorScale"),
+	1.0f,
+	TEXT("Resolution of the mirror image relative to the desktop window, from 0.25 to 1 (default 1).\n")
+	TEXT("Below 1 the eye images are downsampled into a smaller texture, which is then stretched to fill the window"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFovePosePrediction(
+	TEXT("fove.PosePrediction"),
+	-1.0f,
+	TEXT("How far ahead the HMD pose is extrapolated, using the velocities and accelerations reported with it.\n")
+	TEXT(" -1: Estimate the time from fetching the render pose to display from the measured compositor frame period (default)\n")
+	TEXT("  0: No prediction\n")
+	TEXT(" >0: Time in milliseconds from fetching the render pose to display"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveEyeGeometryRefreshInterval(
+	TEXT("fove.EyeGeometryRefreshInterval"),
+	2.0f,
+	TEXT("Seconds between refreshes of the cached IOD and eye to head transforms used to place the stereo views and eye tracking components.\n")
+	TEXT("These only change when the headset is adjusted, so there is no need to fetch them from the FOVE service every frame"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveHealthPollInterval(
+	TEXT("fove.HealthPollInterval"),
+	0.5f,
+	TEXT("Seconds between polls of the FOVE system health by the background health monitor, which detects disconnects and reconnects"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveDiscoveryTimeout(
+	TEXT("fove.DiscoveryTimeout"),
+	2.0f,
+	TEXT("Longest time in seconds that engine startup waits for the background headset discovery, counted from when the plugin is loaded.\n")
+	TEXT("Discovery overlaps with the rest of startup, so this is only waited on when the FOVE service is slow to respond or not running.\n")
+	TEXT("If discovery takes longer, the engine picks its HMD without the FOVE headset"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFoveErrorLogInterval(
+	TEXT("fove.ErrorLogInterval"),
+	5.0f,
+	TEXT("Seconds between summaries of repeated FOVE service errors in the log.\n")
+	TEXT("The first occurrence of each error from each FOVE API is always logged straight away, and repeats are counted and summarised at this interval"),
+	ECVF_Default);
+
+//---------------------------------------------------
+// Stats
+//---------------------------------------------------
+
+// Use "stat FoveHMD" to view these on screen, or "stat startfile" to capture them
+DECLARE_STATS_GROUP(TEXT("FoveHMD"), STATGROUP_FoveHMD, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("WaitForRenderPose"), STAT_FoveWaitForRenderPose, STATGROUP_FoveHMD);
+DECLARE_CYCLE_STAT(TEXT("Compositor Submit"), STAT_FoveSubmit, STATGROUP_FoveHMD);
+DECLARE_CYCLE_STAT(TEXT("Mirror to window"), STAT_FoveMirror, STATGROUP_FoveHMD);
+DECLARE_CYCLE_STAT(TEXT("Foveation composite"), STAT_FoveFoveation, STATGROUP_FoveHMD);
+DECLARE_CYCLE_STAT(TEXT("Swap chain slot wait"), STAT_FoveSwapChainWait, STATGROUP_FoveHMD);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Service calls (game/render)"), STAT_FoveServiceCalls, STATGROUP_FoveHMD);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Service calls (gaze sampler)"), STAT_FoveSamplerServiceCalls, STATGROUP_FoveHMD);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Service calls (health monitor)"), STAT_FoveMonitorServiceCalls, STATGROUP_FoveHMD);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Service calls (loading layer)"), STAT_FoveLoadingServiceCalls, STATGROUP_FoveHMD);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Loading layer frames"), STAT_FoveLoadingFrames, STATGROUP_FoveHMD);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Pose age at submit (ms)"), STAT_FovePoseAgeAtSubmit, STATGROUP_FoveHMD);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Service errors"), STAT_FoveServiceErrors, STATGROUP_FoveHMD);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Service errors (not logged)"), STAT_FoveSuppressedServiceErrors, STATGROUP_FoveHMD);
+
+//---------------------------------------------------
+// FoveInvoke
+//---------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma region FoveInvoke
+#else
+#pragma mark FoveInvoke
+#endif
+
+// Every IFVRHeadset/IFVRCompositor function called by the plugin, along with the interface it belongs to
+#define FOVE_API_LIST(X) \
+	X(Headset, Initialise) \
+	X(Headset, IsHardwareConnected) \
+	X(Headset, IsHardwareReady) \
+	X(Headset, IsEyeTrackingCalibrating) \
+	X(Headset, EnsureEyeTrackingCalibration) \
+	X(Headset, ManualDriftCorrection3D) \
+	X(Headset, IsPositionReady) \
+	X(Headset, TareOrientationSensor) \
+	X(Headset, TarePositionSensors) \
+	X(Headset, GetIOD) \
+	X(Headset, GetEyeToHeadMatrices) \
+	X(Headset, GetHMDPose) \
+	X(Headset, GetProjectionMatricesLH) \
+	X(Headset, GetRawProjectionValues) \
+	X(Headset, GetGazeVectors) \
+	X(Headset, GetGazeConvergence) \
+	X(Headset, CheckEyesTracked) \
+	X(Headset, CheckEyesClosed) \
+	X(Headset, GetSystemHealth) \
+	X(Compositor, IsReady) \
+	X(Compositor, CreateLayer) \
+	X(Compositor, WaitForRenderPose) \
+	X(Compositor, GetLastRenderPose) \
+	X(Compositor, SubmitGroup) \
+	X(Compositor, GetAdapterId)
+
+enum class EFoveApi : uint8
+{
+#define FOVE_API_ENUM(Interface, Name) Name,
+	FOVE_API_LIST(FOVE_API_ENUM)
+#undef FOVE_API_ENUM
+	Count
+};
+
+static const TCHAR* GetFoveApiName(const EFoveApi Api)
+{
+	static const TCHAR* const Names[] =
+	{
+#define FOVE_API_NAME(Interface, Name) TEXT("IFVR") TEXT(#Interface) TEXT("::") TEXT(#Name),
+		FOVE_API_LIST(FOVE_API_NAME)
+#undef FOVE_API_NAME
+	};
+	static_assert(ARRAY_COUNT(Names) == static_cast<int32>(EFoveApi::Count), "FOVE API name table is out of date");
+	return Names[static_cast<int32>(Api)];
+}
+
+// Call count, latency and error statistics for each FOVE API, see the fove.ApiStats console command
+// Recording is lock free (only atomics are used) so it can be done from the game, render and sampler threads alike
+// Latencies are kept as a histogram with four buckets per power of two microseconds, which gives percentiles to within ~20%
+class FFoveApiStats
+{
+public:
+
+	void Record(const EFoveApi Api, const double Seconds, const bool bError)
+	{
+		FEntry& Entry = Entries[static_cast<int32>(Api)];
+		const int64 Micros = FMath::Max<int64>(1, static_cast<int64>(Seconds * 1000000.0));
+
+		FPlatformAtomics::InterlockedIncrement(&Entry.Count);
+		FPlatformAtomics::InterlockedAdd(&Entry.TotalMicros, Micros);
+		FPlatformAtomics::InterlockedIncrement(&Entry.Buckets[GetBucket(Micros)]);
+		if (bError)
+			FPlatformAtomics::InterlockedIncrement(&Entry.Errors);
+
+		for (int64 Min = Entry.MinMicros; Micros < Min; )
+		{
+			const int64 Previous = FPlatformAtomics::InterlockedCompareExchange(&Entry.MinMicros, Micros, Min);
+			if (Previous == Min)
+				break;
+			Min = Previous;
+		}
+
+		for (int64 Max = Entry.MaxMicros; Micros > Max; )
+		{
+			const int64 Previous = FPlatformAtomics::InterlockedCompareExchange(&Entry.MaxMicros, Micros, Max);
+			if (Previous == Max)
+				break;
+			Max = Previous;
+		}
+	}
+
+	// Clears all statistics. Calls that are being recorded at the same time may be partially kept
+	void Reset()
+	{
+		for (FEntry& Entry : Entries)
+		{
+			FPlatformAtomics::InterlockedExchange(&Entry.Count, 0);
+			FPlatformAtomics::InterlockedExchange(&Entry.Errors, 0);
+			FPlatformAtomics::InterlockedExchange(&Entry.TotalMicros, 0);
+			FPlatformAtomics::InterlockedExchange(&Entry.MinMicros, MAX_int64);
+			FPlatformAtomics::InterlockedExchange(&Entry.MaxMicros, 0);
+			for (volatile int64& Bucket : Entry.Buckets)
+				FPlatformAtomics::InterlockedExchange(&Bucket, 0);
+		}
+	}
+
+	// Writes a table of all APIs that have been called to the log
+	void Dump() const
+	{
+		UE_LOG(LogHMD, Display, TEXT("%-44s %10s %8s %10s %10s %10s %10s"), TEXT("FOVE API"), TEXT("Calls"), TEXT("Errors"), TEXT("Min ms"), TEXT("Mean ms"), TEXT("P99 ms"), TEXT("Max ms"));
+		for (int32 i = 0; i < static_cast<int32>(EFoveApi::Count); ++i)
+		{
+			const FEntry& Entry = Entries[i];
+			const int64 Count = Entry.Count;
+			if (Count == 0)
+				continue;
+
+			UE_LOG(LogHMD, Display, TEXT("%-44s %10lld %8lld %10.3f %10.3f %10.3f %10.3f"),
+				GetFoveApiName(static_cast<EFoveApi>(i)),
+				Count,
+				static_cast<int64>(Entry.Errors),
+				Entry.MinMicros / 1000.0,
+				Entry.TotalMicros / 1000.0 / Count,
+				GetPercentileMicros(Entry, 0.99) / 1000.0,
+				Entry.MaxMicros / 1000.0);
+		}
+	}
+
+private:
+
+	static const int32 NumBuckets = 4 * 40;
+
+	struct FEntry
+	{
+		volatile int64 Count = 0;
+		volatile int64 Errors = 0;
+		volatile int64 TotalMicros = 0;
+		volatile int64 MinMicros = MAX_int64;
+		volatile int64 MaxMicros = 0;
+		volatile int64 Buckets[NumBuckets] = {};
+	};
+
+	static int32 GetBucket(const int64 Micros)
+	{
+		// The power of two picks the group of four buckets, and the next two bits below the top bit pick the bucket within it
+		const uint64 Value = static_cast<uint64>(Micros);
+		const int32 Log = static_cast<int32>(FPlatformMath::FloorLog2_64(Value));
+		const int32 Fraction = static_cast<int32>(Log >= 2 ? (Value >> (Log - 2)) & 3 : (Value << (2 - Log)) & 3);
+		return FMath::Min(Log * 4 + Fraction, NumBuckets - 1);
+	}
+
+	static double GetBucketUpperMicros(const int32 Bucket)
+	{
+		return FMath::Pow(2.0f, static_cast<float>(Bucket / 4)) * (5 + Bucket % 4) / 4.0;
+	}
+
+	static double GetPercentileMicros(const FEntry& Entry, const double Percentile)
+	{
+		int64 Total = 0;
+		for (const volatile int64& Bucket : Entry.Buckets)
+			Total += Bucket;
+
+		const double Target = Total * Percentile;
+		int64 Seen = 0;
+		for (int32 i = 0; i < NumBuckets; ++i)
+		{
+			Seen += Entry.Buckets[i];
+			if (Seen > 0 && Seen >= Target)
+				return FMath::Min(GetBucketUpperMicros(i), static_cast<double>(Entry.MaxMicros));
+		}
+		return static_cast<double>(Entry.MaxMicros);
+	}
+
+	FEntry Entries[static_cast<int32>(EFoveApi::Count)];
+};
+
+static FFoveApiStats GFoveApiStats;
+
+static FAutoConsoleCommand CFoveApiStatsCommand(
+	TEXT("fove.ApiStats"),
+	TEXT("Logs the call count, latency (min/mean/p99/max) and error count of each FOVE API called so far. Pass \"reset\" to clear them"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+			GFoveApiStats.Reset();
+		else
+			GFoveApiStats.Dump();
+	}));
+
+// Deduplicates FOVE service errors so that a disconnected headset doesn't produce a log line per call per frame
+// Each API has a few slots, each counting one error code. Counting is lock free and can happen from any thread,
+// and the first occurrence of each API/error pair is logged straight away. Repeats are logged as a single summary line
+// per API/error pair at most every fove.ErrorLogInterval seconds
+class FFoveErrorReporter
+{
+public:
+
+	void Report(const EFoveApi Api, const Fove::EFVR_ErrorCode Error)
+	{
+		INC_DWORD_STAT(STAT_FoveServiceErrors);
+
+		const int32 Code = static_cast<int32>(Error);
+		FSlot* const ApiSlots = Slots[static_cast<int32>(Api)];
+		for (int32 i = 0; i < SlotsPerApi; ++i)
+		{
+			FSlot& Slot = ApiSlots[i];
+			int32 SlotCode = Slot.Code;
+			if (SlotCode == 0)
+			{
+				// Claim the free slot. If another thread beat us to it, it may have claimed it with this same code
+				SlotCode = FPlatformAtomics::InterlockedCompareExchange(&Slot.Code, Code, 0);
+				if (SlotCode == 0)
+				{
+					FPlatformAtomics::InterlockedIncrement(&Slot.Count);
+					FPlatformAtomics::InterlockedIncrement(&Slot.Logged);
+					UE_LOG(LogHMD, Warning, TEXT("%s failed: %d"), GetFoveApiName(Api), Code);
+					return;
+				}
+			}
+
+			if (SlotCode == Code)
+			{
+				FPlatformAtomics::InterlockedIncrement(&Slot.Count);
+				INC_DWORD_STAT(STAT_FoveSuppressedServiceErrors);
+				FlushIfDue();
+				return;
+			}
+		}
+
+		// Every slot for this API is taken by another error code, which is only expected with a misbehaving service
+		INC_DWORD_STAT(STAT_FoveSuppressedServiceErrors);
+		FPlatformAtomics::InterlockedIncrement(&Overflow);
+		FlushIfDue();
+	}
+
+	// Logs a summary of the errors that have repeated since the last summary, if fove.ErrorLogInterval has passed
+	// This is called from Report, and also once per game frame so that errors which have stopped still get summarised
+	void FlushIfDue()
+	{
+		const double Now = FPlatformTime::Seconds();
+		const int64 NowMillis = static_cast<int64>(Now * 1000.0);
+		const int64 LastMillis = LastFlushMillis;
+		if (NowMillis - LastMillis < static_cast<int64>(CVarFoveErrorLogInterval.GetValueOnAnyThread() * 1000.0f))
+			return;
+
+		// Only one thread gets to write the summary
+		if (FPlatformAtomics::InterlockedCompareExchange(&LastFlushMillis, NowMillis, LastMillis) != LastMillis)
+			return;
+
+		const float Seconds = (NowMillis - LastMillis) / 1000.0f;
+		for (int32 ApiIndex = 0; ApiIndex < static_cast<int32>(EFoveApi::Count); ++ApiIndex)
+		{
+			for (FSlot& Slot : Slots[ApiIndex])
+			{
+				if (Slot.Code == 0)
+					break;
+
+				const int64 Count = Slot.Count;
+				const int64 Repeats = Count - Slot.Logged;
+				if (Repeats <= 0)
+					continue;
+
+				FPlatformAtomics::InterlockedAdd(&Slot.Logged, Repeats);
+				UE_LOG(LogHMD, Warning, TEXT("%s failed: %d (repeated %lld times in the last %.1f seconds)"), GetFoveApiName(static_cast<EFoveApi>(ApiIndex)), static_cast<int32>(Slot.Code), Repeats, Seconds);
+			}
+		}
+
+		const int64 Overflowed = FPlatformAtomics::InterlockedExchange(&Overflow, 0);
+		if (Overflowed > 0)
+			UE_LOG(LogHMD, Warning, TEXT("%lld other FOVE service errors in the last %.1f seconds"), Overflowed, Seconds);
+	}
+
+private:
+
+	static const int32 SlotsPerApi = 4;
+
+	struct FSlot
+	{
+		volatile int32 Code = 0;   // EFVR_ErrorCode counted by this slot, or 0 (EFVR_ErrorCode::None) if free
+		volatile int64 Count = 0;  // Number of times it has occurred
+		volatile int64 Logged = 0; // Number of those that have been logged, either on their own or in a summary
+	};
+
+	FSlot Slots[static_cast<int32>(EFoveApi::Count)][SlotsPerApi];
+	volatile int64 Overflow = 0;
+	volatile int64 LastFlushMillis = 0;
+};
+
+static FFoveErrorReporter GFoveErrorReporter;
+
+// How a call made through FoveInvoke is accounted for
+enum class EFoveInvoke : uint8
+{
+	Default, // Counted as a game/render thread call
+	Sampler, // Counted as a gaze sampler call
+	Monitor, // Counted as a health monitor call
+	Loading, // Counted as a loading layer call
+};
+
+// Makes a call into the FOVE service, recording its latency and result in the per-API statistics above
+// Failures are reported here through GFoveErrorReporter, so callers only need to act on the returned error code
+template <typename CallType>
+static Fove::EFVR_ErrorCode FoveInvoke(const EFoveApi Api, const CallType& Call, const EFoveInvoke Mode = EFoveInvoke::Default)
+{
+	if (Mode == EFoveInvoke::Sampler)
+	{
+		INC_DWORD_STAT(STAT_FoveSamplerServiceCalls);
+	}
+	else if (Mode == EFoveInvoke::Monitor)
+	{
+		INC_DWORD_STAT(STAT_FoveMonitorServiceCalls);
+	}
+	else if (Mode == EFoveInvoke::Loading)
+	{
+		INC_DWORD_STAT(STAT_FoveLoadingServiceCalls);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_FoveServiceCalls);
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const Fove::EFVR_ErrorCode Error = Call();
+	GFoveApiStats.Record(Api, FPlatformTime::Seconds() - StartTime, Error != Fove::EFVR_ErrorCode::None);
+
+	if (Error != Fove::EFVR_ErrorCode::None)
+		GFoveErrorReporter.Report(Api, Error);
+
+	return Error;
+}
+
+#ifdef _MSC_VER
+#pragma endregion
+#endif
+
 //---------------------------------------------------
 // Helpers
 //---------------------------------------------------
@@ -69,6 +616,17 @@ FMatrix ToUnreal(const Fove::SFVR_Matrix44& tm)
 		FPlane(tm.mat[0][3], tm.mat[1][3], tm.mat[2][3], tm.mat[3][3]));
 }
 
+// Converts a projection matrix from GetProjectionMatricesLH to Unreal, and corrects the near/far clip (which use reversed-Z in Unreal)
+static FMatrix ToUnrealProjection(const Fove::SFVR_Matrix44& tm, const float ZNear, const float ZFar)
+{
+	FMatrix Ret = ToUnreal(tm);
+	Ret.M[3][3] = 0.0f;
+	Ret.M[2][3] = 1.0f;
+	Ret.M[2][2] = ZNear == ZFar ? 0.0f : ZNear / (ZNear - ZFar);
+	Ret.M[3][2] = ZNear == ZFar ? ZNear : -ZFar * ZNear / (ZNear - ZFar);
+	return Ret;
+}
+
 FQuat ToUnreal(const Fove::SFVR_Quaternion quat)
 {
 	return FQuat(quat.z, quat.x, quat.y, quat.w);
@@ -86,6 +644,38 @@ FTransform ToUnreal(const Fove::SFVR_Pose& pose, const float scale)
 	return FTransform(FoveOrientation, FovePosition);
 }
 
+// Extrapolates a pose forward in time by the given number of seconds, using the velocities and accelerations reported with it
+static Fove::SFVR_Pose PredictPose(const Fove::SFVR_Pose& pose, const float seconds)
+{
+	if (seconds <= 0.0f)
+		return pose;
+
+	Fove::SFVR_Pose ret = pose;
+	const float halfSecondsSquared = 0.5f * seconds * seconds;
+
+	ret.position.x += pose.velocity.x * seconds + pose.acceleration.x * halfSecondsSquared;
+	ret.position.y += pose.velocity.y * seconds + pose.acceleration.y * halfSecondsSquared;
+	ret.position.z += pose.velocity.z * seconds + pose.acceleration.z * halfSecondsSquared;
+
+	// Integrate the angular velocity into a rotation vector, and apply it on top of the current orientation
+	// SFVR_Pose doesn't say which frame angularVelocity is in. It is reported next to velocity and acceleration, which are in tracking space,
+	// and is treated as tracking space too, so the rotation goes on the left (applied after the orientation)
+	// A rate in the head's own frame would go on the right instead
+	const FVector rotation(
+		pose.angularVelocity.x * seconds + pose.angularAcceleration.x * halfSecondsSquared,
+		pose.angularVelocity.y * seconds + pose.angularAcceleration.y * halfSecondsSquared,
+		pose.angularVelocity.z * seconds + pose.angularAcceleration.z * halfSecondsSquared);
+	const float angle = rotation.Size();
+	if (angle > KINDA_SMALL_NUMBER)
+	{
+		const FQuat orientation = FQuat(rotation / angle, angle) * FQuat(pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w);
+		ret.orientation = Fove::SFVR_Quaternion(orientation.X, orientation.Y, orientation.Z, orientation.W);
+	}
+
+	ret.timestamp += static_cast<std::uint64_t>(seconds * 1000.0f);
+	return ret;
+}
+
 // Helper function for acquiring the appropriate FSceneViewport
 FSceneViewport* FoveFindSceneViewport()
 {
@@ -123,9 +713,7 @@ bool IsFoveConnected(Fove::IFVRHeadset& headset, Fove::IFVRCompositor& composito
 {
 	// Headset must be plugged in
 	bool isHardwareConnected = false;
-	Fove::EFVR_ErrorCode Error = headset.IsHardwareConnected(&isHardwareConnected);
-	if (Error != Fove::EFVR_ErrorCode::None)
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::IsHardwareConnected failed: %d"), static_cast<int>(Error));
+	FoveInvoke(EFoveApi::IsHardwareConnected, [&] { return headset.IsHardwareConnected(&isHardwareConnected); });
 	if (!isHardwareConnected)
 		return false;
 
@@ -133,54 +721,143 @@ bool IsFoveConnected(Fove::IFVRHeadset& headset, Fove::IFVRCompositor& composito
 	// This is an important step because there are potentially other Unreal plugins that support FOVE (such as SteamVR and OSVR)
 	// In all cases, the FOVE headset may be connected, but we should only use the FOVE plugin when the FOVE compositor is running
 	bool isCompositorReady = false;
-	Error = compositor.IsReady(&isCompositorReady);
-	if (Error != Fove::EFVR_ErrorCode::None)
-		UE_LOG(LogHMD, Warning, TEXT("IFVRCompositor::IsReady failed: %d"), static_cast<int>(Error));
+	FoveInvoke(EFoveApi::IsReady, [&] { return compositor.IsReady(&isCompositorReady); });
 	if (!isCompositorReady)
 		return false;
 	
 	return true;
 }
 
-#ifdef _MSC_VER
-#pragma endregion
-#endif
+// Returns the settings used for the compositor layer that the game is rendered into
+static Fove::SFVR_CompositorLayerCreateInfo GetLayerCreateInfo()
+{
+	Fove::SFVR_CompositorLayerCreateInfo LayerCreateInfo;
+	LayerCreateInfo.disableTimeWarp = FoveMode == FoveUnrealPluginMode::FixedToHMDScreen;
+	return LayerCreateInfo;
+}
 
-//---------------------------------------------------
-// FoveRenderingBridge
-//---------------------------------------------------
+#if FOVEHMD_SUPPORTS_FOVEATION
+// Stereo passes of the full resolution inset of each eye, see fove.Foveation
+// These are numbered after the engine's own passes, so the renderer treats them as extra stereo views rather than as one of the eyes
+static const EStereoscopicPass eSSP_FOVE_LEFT_INSET = static_cast<EStereoscopicPass>(eSSP_MONOSCOPIC_EYE + 1);
+static const EStereoscopicPass eSSP_FOVE_RIGHT_INSET = static_cast<EStereoscopicPass>(eSSP_MONOSCOPIC_EYE + 2);
+#endif
 
-#ifdef _MSC_VER
-#pragma region FoveRenderingBridge
+// Returns whether a stereo pass renders the foveation inset of an eye
+static bool IsFoveInsetPass(const EStereoscopicPass StereoPass)
+{
+#if FOVEHMD_SUPPORTS_FOVEATION
+	return StereoPass == eSSP_FOVE_LEFT_INSET || StereoPass == eSSP_FOVE_RIGHT_INSET;
 #else
-#pragma mark FoveRenderingBridge
+	return false;
 #endif
+}
 
-class FoveRenderingBridge : public FRHICustomPresent
+// Returns the index of the eye (0 for left, 1 for right) that a stereo pass renders, including the foveation insets
+static int32 GetFoveEyeIndex(const EStereoscopicPass StereoPass)
+{
+#if FOVEHMD_SUPPORTS_FOVEATION
+	if (StereoPass == eSSP_FOVE_LEFT_INSET)
+		return 0;
+	if (StereoPass == eSSP_FOVE_RIGHT_INSET)
+		return 1;
+#endif
+	return StereoPass == eSSP_LEFT_EYE ? 0 : 1;
+}
+
+// Fixed size ring buffer with a single producer thread and any number of reader threads
+// The producer never blocks, and overwrites the oldest elements once the ring is full
+// Readers never block the producer either: each slot carries the sequence number of the element in it,
+// which readers check before and after copying out, so a read that raced with an overwrite is detected and discarded
+template <typename ElementType, uint32 Capacity>
+class TFoveSampleRing
 {
+	static_assert((Capacity & (Capacity - 1)) == 0, "TFoveSampleRing capacity must be a power of two");
+
 public:
-	FoveRenderingBridge(const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe>& compositor) : FRHICustomPresent(nullptr), Compositor(compositor) {}
-	virtual ~FoveRenderingBridge() {}
 
-	void OnBackBufferResize() override {} // Ignored
+	// Appends an element and returns its sequence number (the first element is 1)
+	// Must only be called from the producer thread
+	uint64 Push(const ElementType& Element)
+	{
+		const uint64 Sequence = WriteCount + 1;
+		FSlot& Slot = Slots[Sequence & (Capacity - 1)];
+
+		// Invalidate the slot while writing so that readers of the old element notice
+		Slot.Sequence = 0;
+		FPlatformMisc::MemoryBarrier();
+		Slot.Element = Element;
+		FPlatformMisc::MemoryBarrier();
+		Slot.Sequence = Sequence;
+		FPlatformMisc::MemoryBarrier();
+		WriteCount = Sequence;
+
+		return Sequence;
+	}
 
-	const void SetRenderPose(const Fove::SFVR_Pose& pose, const float WorldToMetersScale)
+	// Returns the sequence number of the newest element, or zero if nothing has been pushed yet
+	uint64 GetLatestSequence() const
 	{
-		FovePose = pose;
-		Pose = ToUnreal(FovePose, WorldToMetersScale);
+		return WriteCount;
 	}
 
-	const FTransform& GetRenderPose() const
+	// Copies out the element with the given sequence number
+	// Returns false if that element has not been written yet or has already been overwritten
+	bool Read(const uint64 Sequence, ElementType& OutElement) const
 	{
-		return Pose;
+		const FSlot& Slot = Slots[Sequence & (Capacity - 1)];
+		if (Sequence == 0 || Slot.Sequence != Sequence)
+			return false;
+
+		FPlatformMisc::MemoryBarrier();
+		OutElement = Slot.Element;
+		FPlatformMisc::MemoryBarrier();
+
+		return Slot.Sequence == Sequence;
 	}
 
-	virtual void UpdateViewport(const FViewport& Viewport) = 0;
+	// Copies out the newest element, returns false if there is none
+	bool ReadLatest(ElementType& OutElement) const
+	{
+		// A failed read means the producer lapped us, in which case there is an even newer element to try
+		for (int32 Attempt = 0; Attempt < 4; ++Attempt)
+		{
+			const uint64 Sequence = WriteCount;
+			if (Sequence == 0)
+				return false;
+			if (Read(Sequence, OutElement))
+				return true;
+		}
+		return false;
+	}
 
-protected:
-	const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe> Compositor;  // Pointer back to the Fove plugin object that owns us
-	Fove::SFVR_Pose FovePose;  // Pose fetched out via WaitForRenderPose, used internally to submit frames back to fove
-	FTransform Pose;           // Same as RenderPose, but converted to Unreal coordinates
+	// Appends all elements newer than Sequence to OutElements, oldest first
+	// Returns the sequence number of the newest element at the time of the call
+	uint64 ReadSince(const uint64 Sequence, TArray<ElementType>& OutElements) const
+	{
+		const uint64 Latest = WriteCount;
+		const uint64 Oldest = Latest >= Capacity ? Latest - Capacity + 1 : 1;
+
+		ElementType Element;
+		for (uint64 Current = FMath::Max(Sequence + 1, Oldest); Current <= Latest; ++Current)
+		{
+			if (Read(Current, Element))
+				OutElements.Add(Element);
+		}
+
+		return FMath::Max(Sequence, Latest);
+	}
+
+private:
+
+	struct FSlot
+	{
+		volatile uint64 Sequence = 0;
+		ElementType Element;
+	};
+
+	FSlot Slots[Capacity];
+	volatile uint64 WriteCount = 0;
 };
 
 #ifdef _MSC_VER
@@ -188,115 +865,1396 @@ protected:
 #endif
 
 //---------------------------------------------------
-// FoveD3D11Bridge
+// FoveRenderingBridge
 //---------------------------------------------------
 
 #ifdef _MSC_VER
-#pragma region FoveD3D11Bridge
+#pragma region FoveRenderingBridge
 #else
-#pragma mark FoveD3D11Bridge
+#pragma mark FoveRenderingBridge
 #endif
 
-#if PLATFORM_WINDOWS
-
-class FoveD3D11Bridge : public FoveRenderingBridge
+class FoveRenderingBridge : public FRHICustomPresent
 {
-	ID3D11Texture2D* RenderTargetTexture = nullptr;
-	const Fove::SFVR_CompositorLayer FoveCompositorLayer;
-
 public:
-	FoveD3D11Bridge(const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe>& Compositor, Fove::SFVR_CompositorLayer Layer)
-		: FoveRenderingBridge(Compositor)
-		, FoveCompositorLayer(Layer)
+	FoveRenderingBridge(const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe>& compositor) : FRHICustomPresent(nullptr), Compositor(compositor)
 	{
+		ActivityEvent = FPlatformProcess::GetSynchEventFromPool();
 	}
 
-	~FoveD3D11Bridge()
+	virtual ~FoveRenderingBridge()
 	{
-		if (RenderTargetTexture)
-			RenderTargetTexture->Release();
+		FPlatformProcess::ReturnSynchEventToPool(ActivityEvent);
 	}
 
-	bool Present(int& SyncInterval) override
+	void OnBackBufferResize() override {} // Ignored
+
+	// Render pose shared with other threads
+	struct FRenderPose
+	{
+		Fove::SFVR_Pose RawPose;   // Pose fetched out via WaitForRenderPose, before prediction
+		Fove::SFVR_Pose FovePose;  // RawPose extrapolated to display time, which is rendered and submitted with
+		FTransform Pose;           // Same as FovePose, but converted to Unreal coordinates
+	};
+
+	// Sets the pose to render and submit with, extrapolated PredictionSeconds ahead to when the frame is expected to be displayed
+	// The compositor is given the predicted pose, so its time warp only has to correct for the prediction error
+	// Must be called from the render thread
+	// PoseTime is when the pose was handed out by the compositor, in FPlatformTime::Seconds()
+	const void SetRenderPose(const Fove::SFVR_Pose& pose, const double PoseTime, const float WorldToMetersScale, const float PredictionSeconds)
 	{
 		check(IsInRenderingThread());
 
-		if (!RenderTargetTexture)
-		{
-			UE_LOG(LogHMD, Warning, TEXT("FOVE present without render texture"));
-			return false;
-		}
+		RenderPoseTime = PoseTime;
+		FovePose = PredictPose(pose, PredictionSeconds);
+		Pose = ToUnreal(FovePose, WorldToMetersScale);
 
-		// Clear rasterizer state to avoid Unreal messing with FOVE submit
-		ID3D11Device* Dev = nullptr;
-		ID3D11DeviceContext* Ctx = nullptr;
-		ID3D11RasterizerState* RasterizerState = nullptr;
-		RenderTargetTexture->GetDevice(&Dev);
-		if (Dev)
-		{
-			Dev->GetImmediateContext(&Ctx);
-			if (Ctx)
-			{
-				D3D11_RASTERIZER_DESC desc = {};
-				Ctx->RSGetState(&RasterizerState);
-				Ctx->RSSetState(nullptr);
-			}
-		}
+		// Publish to the game thread. The ring lets it copy the pose out without a lock, and without ever seeing a half written pose
+		FRenderPose Shared;
+		Shared.RawPose = pose;
+		Shared.FovePose = FovePose;
+		Shared.Pose = Pose;
+		SharedPoses.Push(Shared);
+	}
 
-		// Submit eye images
-		Fove::SFVR_CompositorLayerSubmitInfo info;
-		info.layerId = FoveCompositorLayer.layerId;
-		info.pose = FovePose;
-		info.left.texInfo = RenderTargetTexture;
-		info.right.texInfo = RenderTargetTexture;
-		info.left.bounds.left = 0.0f;
-		info.left.bounds.right = 0.5f;
-		info.left.bounds.bottom = 1.0f;
-		info.left.bounds.top = 0.0f;
-		info.right.bounds.left = 0.5f;
-		info.right.bounds.right = 1.0f;
-		info.right.bounds.bottom = 1.0f;
-		info.right.bounds.top = 0.0f;
-		Compositor->Submit(info);
+	// Returns the pose set by the last SetRenderPose call, converted to Unreal coordinates
+	// Must be called from the render thread
+	const FTransform& GetRenderPose_RenderThread() const
+	{
+		check(IsInRenderingThread());
+		return Pose;
+	}
 
-		// Restore state
-		if (Ctx)
+	// Copies out the pose set by the last SetRenderPose call. Wait free, and may be called from any thread
+	// Returns the generation of the pose, which increases by one with each SetRenderPose call, or zero if there is no pose yet
+	// Callers can compare generations between calls to tell whether the render thread has fetched a new pose since
+	uint64 GetRenderPose(FRenderPose& OutPose) const
+	{
+		// Four slots means the render thread would have to set four poses during a single copy for this to fail
+		for (int32 Attempt = 0; Attempt < 4; ++Attempt)
 		{
-			D3D11_RASTERIZER_DESC desc = {};
-			Ctx->RSSetState(RasterizerState);
+			const uint64 Generation = SharedPoses.GetLatestSequence();
+			if (Generation == 0 || SharedPoses.Read(Generation, OutPose))
+				return Generation;
 		}
+		return 0;
+	}
 
-		return true;
+	// Sets the region of the render target that each eye was rendered into, in 0 to 1 coordinates
+	void SetEyeBounds(const FBox2D& Left, const FBox2D& Right)
+	{
+		EyeBounds[0] = Left;
+		EyeBounds[1] = Right;
 	}
 
-	void UpdateViewport(const FViewport& Viewport) override
+	// An overlay layer submitted along with the scene, see FFoveHMD::CreateOverlayLayer()
+	struct FOverlay
 	{
-		check(IsInGameThread());
+		int LayerId = 0;
+		FTexture2DRHIRef Texture;
+		FBox2D Bounds[2];
+	};
 
-		// Update render target
-		const FTexture2DRHIRef& textureRef = Viewport.GetRenderTargetTexture();
-		ID3D11Texture2D* const newRT = textureRef ? (ID3D11Texture2D*)textureRef->GetNativeResource() : nullptr;
-		if (newRT != RenderTargetTexture)
-		{
-			if (RenderTargetTexture)
-				RenderTargetTexture->Release();
+	// Sets the overlay layers to submit with each frame, replacing the previous set
+	// Must be called from the render thread
+	void SetOverlays(const TArray<FOverlay>& NewOverlays)
+	{
+		check(IsInRenderingThread());
+		Overlays = NewOverlays;
+	}
+
+	// Sets whether Present should wait for the compositor before submitting, see fove.PacingMode
+	void SetWaitInPresent(const bool bWait)
+	{
+		bWaitInPresent = bWait;
+	}
+
+	// Returns how long the last wait made from Present took, in seconds
+	double GetLastPresentWaitSeconds() const
+	{
+		return LastPresentWaitSeconds;
+	}
+
+	// Returns when the last wait made from Present returned, in FPlatformTime::Seconds()
+	double GetLastPresentWaitEndTime() const
+	{
+		return LastPresentWaitEndTime;
+	}
+
+	// Sets whether the next Present should also present the desktop window, which is skipped on frames that aren't mirrored
+	// Must be called from the render thread
+	void SetPresentWindow(const bool bPresent)
+	{
+		check(IsInRenderingThread());
+		bPresentWindow = bPresent;
+	}
+
+	// Records that the render thread is producing frames, which holds off the loading layer, see fove.LoadingLayer
+	// Must be called from the render thread
+	void NoteRenderThreadActivity()
+	{
+		check(IsInRenderingThread());
+		bPresenting = true;
+		ActivityEvent->Trigger();
+	}
+
+	// Records that the bridge has stopped being used for the viewport, so the loading layer doesn't take that for a stall
+	// Must be called from the render thread
+	void NotePresentStopped()
+	{
+		check(IsInRenderingThread());
+		bPresenting = false;
+		ActivityEvent->Trigger();
+	}
+
+	// Returns whether frames are being presented through the bridge. May be called from any thread
+	bool IsPresenting() const
+	{
+		return bPresenting;
+	}
+
+	// Blocks for up to WaitSeconds until NoteRenderThreadActivity is called (or WakeActivityWaiter), returning false if it timed out
+	// Each call consumes the activity recorded since the last one, so only one thread should wait on this. May be called from any thread
+	bool WaitForRenderThreadActivity(const double WaitSeconds)
+	{
+		return ActivityEvent->Wait(FTimespan::FromSeconds(WaitSeconds));
+	}
+
+	// Wakes a thread blocked in WaitForRenderThreadActivity, eg. to shut it down
+	void WakeActivityWaiter()
+	{
+		ActivityEvent->Trigger();
+	}
+
+	// Picks up the render target of the viewport, which is submitted from then on
+	// Must be called from the game thread. The change takes effect on the render thread, in order with the frames around it
+	virtual void UpdateViewport(const FViewport& Viewport) = 0;
+
+	// Sets the compositor layer that frames are submitted to, which changes when the layer is re-created after a reconnect
+	// Must be called from the render thread
+	virtual void SetCompositorLayer(const Fove::SFVR_CompositorLayer& Layer) = 0;
+
+	// Sets a texture to submit in place of the viewport render target, or null to go back to submitting the render target
+	// This is used on frames where the eye images are combined into another texture first, see fove.Foveation
+	// Must be called from the render thread
+	virtual void SetSubmitTexture(const FTexture2DRHIRef& Texture) = 0;
+
+protected:
+	const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe> Compositor;  // Pointer back to the Fove plugin object that owns us
+	Fove::SFVR_Pose FovePose;  // Pose fetched out via WaitForRenderPose and extrapolated to display time, used internally to submit frames back to fove
+	FTransform Pose;           // Same as FovePose, but converted to Unreal coordinates
+	TFoveSampleRing<FRenderPose, 4> SharedPoses; // Copies of the above for other threads, see GetRenderPose()
+
+	// Blocks until the compositor is ready for the next frame, if pacing has been moved to Present
+	// The pose it returns is not used for this frame, which has already been rendered, but is picked up by the next frame via GetLastRenderPose
+	void WaitForCompositorIfNeeded()
+	{
+		if (!bWaitInPresent)
+			return;
+
+		SCOPE_CYCLE_COUNTER(STAT_FoveWaitForRenderPose);
+		Fove::SFVR_Pose NextPose;
+		const double WaitStartTime = FPlatformTime::Seconds();
+		FoveInvoke(EFoveApi::WaitForRenderPose, [&] { return Compositor->WaitForRenderPose(&NextPose); });
+		LastPresentWaitEndTime = FPlatformTime::Seconds();
+		LastPresentWaitSeconds = LastPresentWaitEndTime - WaitStartTime;
+	}
+
+	bool bWaitInPresent = false;          // Set from the render thread each frame
+	bool bPresentWindow = true;           // Whether Present lets the desktop window present the mirror, see SetPresentWindow()
+	double LastPresentWaitSeconds = 0.0;  // Duration of the last wait made from Present
+	double LastPresentWaitEndTime = 0.0;  // Time at which the last wait made from Present returned
+	double RenderPoseTime = 0.0;          // Time at which the compositor handed out the current render pose
+	volatile bool bPresenting = false;    // Whether frames are being presented, see NoteRenderThreadActivity() and NotePresentStopped()
+	FEvent* ActivityEvent = nullptr;      // Triggered by NoteRenderThreadActivity() and NotePresentStopped(), for the loading layer watchdog to wait on
+	FBox2D EyeBounds[2] = { FBox2D(FVector2D(0.0f, 0.0f), FVector2D(0.5f, 1.0f)), FBox2D(FVector2D(0.5f, 0.0f), FVector2D(1.0f, 1.0f)) };
+	TArray<FOverlay> Overlays;            // Overlay layers to submit along with the scene, only accessed on the render thread
+
+	static void SetEyeSubmitInfo(Fove::SFVR_CompositorLayerEyeSubmitInfo& OutInfo, void* const Texture, const FBox2D& Bounds)
+	{
+		OutInfo.texInfo = Texture;
+		OutInfo.bounds.left = Bounds.Min.X;
+		OutInfo.bounds.right = Bounds.Max.X;
+		OutInfo.bounds.bottom = Bounds.Max.Y;
+		OutInfo.bounds.top = Bounds.Min.Y;
+	}
+};
+
+// Background thread which keeps the compositor fed while normal rendering is stalled, see fove.LoadingLayer
+// The loading scene is drawn on the CPU into a texture on the watchdog's own D3D11 device, and submitted to its own overlay layer, so
+// nothing here goes through the render thread or touches Unreal's immediate context. This keeps working however long rendering is stuck
+// The thread lives as long as the FFoveHMD. While fove.LoadingLayer is off, it only wakes up when the render thread presents
+class FFoveLoadingWatchdog : public FRunnable
+{
+public:
+
+	FFoveLoadingWatchdog(const TRefCountPtr<FoveRenderingBridge>& bridge, const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe>& compositor)
+		: Bridge(bridge)
+		, Compositor(compositor)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("FoveLoadingWatchdog"), 0, TPri_AboveNormal);
+	}
+
+	~FFoveLoadingWatchdog()
+	{
+		if (Thread)
+		{
+			Thread->Kill(true);
+			delete Thread;
+		}
+	}
+
+	// Sets the overlay layer that the loading scene is submitted to, which changes when it is re-created after a reconnect
+	// A layerId of 0 disables the loading layer until a valid one is set. May be called from any thread
+	void SetLayer(const int32 LayerId)
+	{
+		FPlatformAtomics::InterlockedExchange(&SubmitLayerId, LayerId);
+	}
+
+	// Sets the frustum extents of each eye at a depth of 1, which the loading scene is drawn with. May be called from any thread
+	void SetEyeFrusta(const Fove::SFVR_ProjectionParams& Left, const Fove::SFVR_ProjectionParams& Right)
+	{
+		FScopeLock Lock(&FrustaLock);
+		Frusta[0] = Left;
+		Frusta[1] = Right;
+	}
+
+public: // FRunnable interface
+
+	uint32 Run() override
+	{
+		bool bStalled = false;
+		uint32 FrameCount = 0;
+		double StallStartTime = 0.0;
+
+		while (!bStopping)
+		{
+			const double StallSeconds = FMath::Max(CVarFoveLoadingLayerTimeout.GetValueOnAnyThread(), 10.0f) / 1000.0;
+
+			if (!bStalled)
+			{
+				// Rendering is running normally as long as the render thread keeps reporting activity within the timeout
+				// While the loading layer can't be used, this only wakes up when the render thread presents (or every half a second)
+				const bool bEnabled = IsEnabled();
+				if (!Bridge->WaitForRenderThreadActivity(bEnabled ? StallSeconds : 0.5) && bEnabled && !bStopping)
+				{
+					bStalled = true;
+					FrameCount = 0;
+					StallStartTime = FPlatformTime::Seconds();
+					bHaveBarDirection = false;
+					UE_LOG(LogHMD, Log, TEXT("FOVE rendering stalled, loading layer is taking over"));
+				}
+				continue;
+			}
+
+			// Go straight on to the next frame until the render thread presents one of its own
+			// If nothing could be submitted (eg. the headset is disconnected), wait for rendering to resume, or for the timeout to pass again
+			const bool bResumed = Bridge->WaitForRenderThreadActivity(0.0) || !IsEnabled()
+				|| (!SubmitFrame(true, FPlatformTime::Seconds() - StallStartTime) && Bridge->WaitForRenderThreadActivity(StallSeconds));
+			if (bResumed)
+			{
+				// Submit one transparent frame, so the loading scene doesn't stay in front of the scene if the compositor keeps showing it
+				SubmitFrame(false, 0.0);
+				bStalled = false;
+				UE_LOG(LogHMD, Log, TEXT("FOVE loading layer handed back to normal rendering after %u frames"), FrameCount);
+			}
+			else
+			{
+				++FrameCount;
+			}
+		}
+
+#if PLATFORM_WINDOWS
+		ReleaseDevice();
+#endif
+		return 0;
+	}
+
+	void Stop() override
+	{
+		bStopping = true;
+		Bridge->WakeActivityWaiter();
+	}
+
+private:
+
+	// Per eye resolution of the loading scene. It is only a gradient and a bar, which the compositor scales up smoothly
+	static const int32 EyeResolution = 256;
+
+	bool IsEnabled() const
+	{
+		return CVarFoveLoadingLayer.GetValueOnAnyThread() != 0 && Bridge->IsPresenting() && SubmitLayerId != 0;
+	}
+
+	// Waits for the compositor and submits a frame of the loading scene, or a transparent frame if bVisible is false
+	// The compositor wait is the only blocking call, and it returns within a frame of the headset's display
+	bool SubmitFrame(const bool bVisible, const double StallTime)
+	{
+#if PLATFORM_WINDOWS
+		if (!CreateDevice())
+			return false;
+
+		Fove::SFVR_Pose Pose;
+		if (FoveInvoke(EFoveApi::WaitForRenderPose, [&] { return Compositor->WaitForRenderPose(&Pose); }, EFoveInvoke::Loading) != Fove::EFVR_ErrorCode::None)
+			return false;
+
+		// The scene is drawn for the pose it is submitted with, so the compositor's time warp keeps it fixed in the world as the head turns
+		if (bVisible)
+			DrawScene(ToUnreal(Pose.orientation), StallTime);
+		else
+			FMemory::Memzero(Pixels.GetData(), Pixels.Num() * sizeof(FColor));
+		Context->UpdateSubresource(Texture, 0, nullptr, Pixels.GetData(), EyeResolution * 2 * sizeof(FColor), 0);
+
+		Fove::SFVR_CompositorLayerSubmitInfo Info;
+		Info.layerId = SubmitLayerId;
+		Info.pose = Pose;
+		Info.left.texInfo = Texture;
+		Info.left.bounds.left = 0.0f;
+		Info.left.bounds.right = 0.5f;
+		Info.left.bounds.bottom = 1.0f;
+		Info.right.texInfo = Texture;
+		Info.right.bounds.left = 0.5f;
+		Info.right.bounds.right = 1.0f;
+		Info.right.bounds.bottom = 1.0f;
+		if (FoveInvoke(EFoveApi::SubmitGroup, [&] { return Compositor->SubmitGroup(&Info, 1); }, EFoveInvoke::Loading) != Fove::EFVR_ErrorCode::None)
+			return false;
+
+		INC_DWORD_STAT(STAT_FoveLoadingFrames);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Draws the loading scene into Pixels, both eyes side by side, for a head with the given orientation
+	// The sky is a gradient by elevation, and the activity bar sits on the horizon in the direction the head faced when the stall began
+	// There is no way to know how far along a load is, so the bar shows a segment sweeping back and forth rather than a fill level
+	void DrawScene(const FQuat& Orientation, const double StallTime)
+	{
+		static const int32 GradientSize = 256;
+		if (Gradient.Num() == 0)
+		{
+			const FLinearColor Ground(0.02f, 0.02f, 0.025f);
+			const FLinearColor Horizon(0.25f, 0.28f, 0.35f);
+			const FLinearColor Zenith(0.04f, 0.08f, 0.2f);
+			Gradient.SetNumUninitialized(GradientSize);
+			for (int32 Index = 0; Index < GradientSize; ++Index)
+			{
+				const float Elevation = Index / (GradientSize - 1.0f) * 2.0f - 1.0f;
+				const FLinearColor Color = Elevation < 0.0f
+					? FLinearColor::LerpUsingHSV(Horizon, Ground, FMath::Min(-Elevation * 8.0f, 1.0f))
+					: FLinearColor::LerpUsingHSV(Horizon, Zenith, FMath::Sqrt(Elevation));
+				Gradient[Index] = Color.ToFColor(true);
+			}
+		}
+
+		if (!bHaveBarDirection)
+		{
+			const float Yaw = FMath::DegreesToRadians(Orientation.Rotator().Yaw);
+			BarForward = FVector(FMath::Cos(Yaw), FMath::Sin(Yaw), 0.0f);
+			BarRight = FVector(-FMath::Sin(Yaw), FMath::Cos(Yaw), 0.0f);
+			bHaveBarDirection = true;
+		}
+
+		// Bar extents on the plane one unit in front of the viewer, and the sweeping segment within it
+		const float BarHalfWidth = 0.3f;
+		const float BarHalfHeight = 0.025f;
+		const float BarBorder = 0.006f;
+		const float SegmentHalfWidth = 0.06f;
+		const float SegmentCenter = FMath::Sin(static_cast<float>(StallTime) * 2.0f) * (BarHalfWidth - BarBorder - SegmentHalfWidth);
+		const FColor BarBorderColor(230, 230, 230, 255);
+		const FColor BarBackColor(40, 40, 48, 255);
+		const FColor SegmentColor(255, 255, 255, 255);
+
+		Fove::SFVR_ProjectionParams EyeFrusta[2];
+		{
+			FScopeLock Lock(&FrustaLock);
+			EyeFrusta[0] = Frusta[0];
+			EyeFrusta[1] = Frusta[1];
+		}
+
+		const FVector Forward = Orientation.RotateVector(FVector::ForwardVector);
+		const FVector Right = Orientation.RotateVector(FVector::RightVector);
+		const FVector Up = Orientation.RotateVector(FVector::UpVector);
+		const int32 Stride = EyeResolution * 2;
+		Pixels.SetNumUninitialized(Stride * EyeResolution);
+
+		for (int32 Eye = 0; Eye < 2; ++Eye)
+		{
+			const Fove::SFVR_ProjectionParams& Frustum = EyeFrusta[Eye];
+			for (int32 Y = 0; Y < EyeResolution; ++Y)
+			{
+				const float TanY = FMath::Lerp(Frustum.top, Frustum.bottom, (Y + 0.5f) / EyeResolution);
+				const FVector RowDir = Forward + Up * TanY;
+				FColor* const Row = &Pixels[Y * Stride + Eye * EyeResolution];
+				for (int32 X = 0; X < EyeResolution; ++X)
+				{
+					const float TanX = FMath::Lerp(Frustum.left, Frustum.right, (X + 0.5f) / EyeResolution);
+					const FVector Dir = RowDir + Right * TanX;
+
+					// Project onto the bar's plane, which only the directions in front of it reach
+					const float Depth = FVector::DotProduct(Dir, BarForward);
+					if (Depth > 0.0f)
+					{
+						const float BarX = FVector::DotProduct(Dir, BarRight) / Depth;
+						const float BarY = Dir.Z / Depth;
+						if (FMath::Abs(BarX) < BarHalfWidth && FMath::Abs(BarY) < BarHalfHeight)
+						{
+							const bool bInside = FMath::Abs(BarX) < BarHalfWidth - BarBorder && FMath::Abs(BarY) < BarHalfHeight - BarBorder;
+							Row[X] = !bInside ? BarBorderColor : FMath::Abs(BarX - SegmentCenter) < SegmentHalfWidth ? SegmentColor : BarBackColor;
+							continue;
+						}
+					}
+
+					const float Elevation = Dir.Z * FMath::InvSqrt(Dir.SizeSquared());
+					Row[X] = Gradient[FMath::Clamp(FMath::TruncToInt((Elevation + 1.0f) * 0.5f * (GradientSize - 1) + 0.5f), 0, GradientSize - 1)];
+				}
+			}
+		}
+	}
+
+#if PLATFORM_WINDOWS
+	// Creates the device and texture the loading scene is submitted from, on the first stall. Only tried once
+	// The device is created on the adapter the compositor runs on, falling back to the default one if it can't be found
+	bool CreateDevice()
+	{
+		if (Texture)
+			return true;
+		if (bDeviceFailed)
+			return false;
+		bDeviceFailed = true;
+
+		IDXGIAdapter1* Adapter = nullptr;
+		Fove::SFVR_AdapterId AdapterId;
+		IDXGIFactory1* Factory = nullptr;
+		if (FoveInvoke(EFoveApi::GetAdapterId, [&] { return Compositor->GetAdapterId(&AdapterId); }, EFoveInvoke::Loading) == Fove::EFVR_ErrorCode::None
+			&& SUCCEEDED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), reinterpret_cast<void**>(&Factory))))
+		{
+			IDXGIAdapter1* Candidate = nullptr;
+			for (UINT Index = 0; !Adapter && Factory->EnumAdapters1(Index, &Candidate) != DXGI_ERROR_NOT_FOUND; ++Index)
+			{
+				DXGI_ADAPTER_DESC1 AdapterDesc;
+				if (SUCCEEDED(Candidate->GetDesc1(&AdapterDesc)) && AdapterDesc.AdapterLuid.LowPart == AdapterId.lowPart && AdapterDesc.AdapterLuid.HighPart == AdapterId.highPart)
+					Adapter = Candidate;
+				else
+					Candidate->Release();
+			}
+			Factory->Release();
+		}
+
+		const HRESULT Result = D3D11CreateDevice(Adapter, Adapter ? D3D_DRIVER_TYPE_UNKNOWN : D3D_DRIVER_TYPE_HARDWARE, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, &Device, nullptr, &Context);
+		if (Adapter)
+			Adapter->Release();
+		if (FAILED(Result))
+		{
+			UE_LOG(LogHMD, Warning, TEXT("Failed to create the FOVE loading layer device: 0x%08x"), static_cast<uint32>(Result));
+			ReleaseDevice();
+			return false;
+		}
+
+		D3D11_TEXTURE2D_DESC Desc = {};
+		Desc.Width = EyeResolution * 2;
+		Desc.Height = EyeResolution;
+		Desc.MipLevels = 1;
+		Desc.ArraySize = 1;
+		Desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM; // Matches the memory layout of FColor
+		Desc.SampleDesc.Count = 1;
+		Desc.Usage = D3D11_USAGE_DEFAULT;
+		Desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		if (FAILED(Device->CreateTexture2D(&Desc, nullptr, &Texture)))
+		{
+			UE_LOG(LogHMD, Warning, TEXT("Failed to create the FOVE loading layer texture"));
+			ReleaseDevice();
+			return false;
+		}
+
+		Pixels.SetNumZeroed(EyeResolution * 2 * EyeResolution);
+		bDeviceFailed = false;
+		return true;
+	}
+
+	void ReleaseDevice()
+	{
+		if (Texture)
+		{
+			Texture->Release();
+			Texture = nullptr;
+		}
+		if (Context)
+		{
+			Context->Release();
+			Context = nullptr;
+		}
+		if (Device)
+		{
+			Device->Release();
+			Device = nullptr;
+		}
+	}
+
+	// Only accessed on the watchdog thread
+	ID3D11Device* Device = nullptr;
+	ID3D11DeviceContext* Context = nullptr;
+	ID3D11Texture2D* Texture = nullptr;
+	bool bDeviceFailed = false;
+#endif
+
+	const TRefCountPtr<FoveRenderingBridge> Bridge;
+	const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe> Compositor;
+	FRunnableThread* Thread = nullptr;
+	volatile bool bStopping = false;
+	volatile int32 SubmitLayerId = 0;
+
+	FCriticalSection FrustaLock;
+	Fove::SFVR_ProjectionParams Frusta[2];
+
+	// Loading scene state, only accessed on the watchdog thread
+	TArray<FColor> Pixels;
+	TArray<FColor> Gradient;
+	FVector BarForward = FVector::ForwardVector;
+	FVector BarRight = FVector::RightVector;
+	bool bHaveBarDirection = false;
+};
+
+#ifdef _MSC_VER
+#pragma endregion
+#endif
+
+//---------------------------------------------------
+// FoveD3D11Bridge
+//---------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma region FoveD3D11Bridge
+#else
+#pragma mark FoveD3D11Bridge
+#endif
+
+#if PLATFORM_WINDOWS
+
+class FoveD3D11Bridge : public FoveRenderingBridge
+{
+	static const int32 MaxSwapChainDepth = 3;
+
+	// Pipeline state which Present changes around the submit, and puts back afterwards so Unreal's cached state stays correct
+	struct FStateBlock
+	{
+		ID3D11RasterizerState* RasterizerState = nullptr;
+
+		void Capture(ID3D11DeviceContext* const Ctx)
+		{
+			Ctx->RSGetState(&RasterizerState);
+		}
+
+		void Restore(ID3D11DeviceContext* const Ctx)
+		{
+			// RSGetState added a reference, which is dropped again once the state has been put back
+			Ctx->RSSetState(RasterizerState);
+			if (RasterizerState)
+			{
+				RasterizerState->Release();
+				RasterizerState = nullptr;
+			}
+		}
+	};
+
+	// Viewport render target, set via UpdateViewport. Only accessed on the render thread
+	ID3D11Texture2D* RenderTargetTexture = nullptr;
+	Fove::SFVR_CompositorLayer FoveCompositorLayer;
+
+	// Texture submitted in place of the render target when set, see SetSubmitTexture(). Only accessed on the render thread
+	FTexture2DRHIRef SubmitTextureOverride;
+
+	// Device and immediate context of RenderTargetTexture, fetched when the render target changes rather than every frame
+	// Like the render target itself, these are only accessed on the render thread
+	ID3D11Device* Device = nullptr;
+	ID3D11DeviceContext* Context = nullptr;
+	FStateBlock SavedState;
+
+	// Textures handed to the compositor, see fove.SwapChainDepth. Only accessed on the render thread
+	// Each has an event query, issued after the texture is submitted, which signals once the GPU is done with that submit
+	ID3D11Texture2D* SwapChainTextures[MaxSwapChainDepth] = {};
+	ID3D11Query* SwapChainQueries[MaxSwapChainDepth] = {};
+	bool SwapChainQueryIssued[MaxSwapChainDepth] = {};
+	D3D11_TEXTURE2D_DESC SwapChainDesc = {}; // Description of the source texture the swap chain was created for
+	int32 SwapChainDepth = 0;                // Number of textures in the swap chain, or 0 if there is none
+	int32 SwapChainIndex = 0;                // Texture that the next frame is copied into
+
+public:
+	FoveD3D11Bridge(const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe>& Compositor, Fove::SFVR_CompositorLayer Layer)
+		: FoveRenderingBridge(Compositor)
+		, FoveCompositorLayer(Layer)
+	{
+	}
+
+	~FoveD3D11Bridge()
+	{
+		ReleaseSwapChain();
+		ReleaseDevice();
+
+		if (RenderTargetTexture)
+			RenderTargetTexture->Release();
+	}
+
+	bool Present(int& SyncInterval) override
+	{
+		check(IsInRenderingThread());
+
+		if (!RenderTargetTexture)
+		{
+			UE_LOG(LogHMD, Warning, TEXT("FOVE present without render texture"));
+			return false;
+		}
+
+		NoteRenderThreadActivity();
+
+		// Clear rasterizer state to avoid Unreal messing with FOVE submit
+		if (Context)
+		{
+			SavedState.Capture(Context);
+			Context->RSSetState(nullptr);
+		}
+
+		// In the deferred pacing mode, this is the latest safe point to wait for the compositor
+		WaitForCompositorIfNeeded();
+
+		// Submit eye images
+		int32 Slot = INDEX_NONE;
+		ID3D11Texture2D* const SourceTexture = SubmitTextureOverride ? static_cast<ID3D11Texture2D*>(SubmitTextureOverride->GetNativeResource()) : RenderTargetTexture;
+		ID3D11Texture2D* const SubmitTexture = CopyToSwapChain(Device, Context, SourceTexture, Slot);
+		TArray<Fove::SFVR_CompositorLayerSubmitInfo, TInlineAllocator<4>> Infos;
+		Fove::SFVR_CompositorLayerSubmitInfo& info = Infos[Infos.AddDefaulted()];
+		info.layerId = FoveCompositorLayer.layerId;
+		info.pose = FovePose;
+		SetEyeSubmitInfo(info.left, SubmitTexture, EyeBounds[0]);
+		SetEyeSubmitInfo(info.right, SubmitTexture, EyeBounds[1]);
+
+		// Overlays are resubmitted every frame from their own textures, which are only redrawn when their content changes
+		for (const FOverlay& Overlay : Overlays)
+		{
+			if (!Overlay.Texture)
+				continue;
+
+			Fove::SFVR_CompositorLayerSubmitInfo& OverlayInfo = Infos[Infos.AddDefaulted()];
+			OverlayInfo.layerId = Overlay.LayerId;
+			OverlayInfo.pose = FovePose;
+			SetEyeSubmitInfo(OverlayInfo.left, Overlay.Texture->GetNativeResource(), Overlay.Bounds[0]);
+			SetEyeSubmitInfo(OverlayInfo.right, Overlay.Texture->GetNativeResource(), Overlay.Bounds[1]);
+		}
+
+		SET_FLOAT_STAT(STAT_FovePoseAgeAtSubmit, RenderPoseTime > 0.0 ? (FPlatformTime::Seconds() - RenderPoseTime) * 1000.0 : 0.0);
+		{
+			SCOPE_CYCLE_COUNTER(STAT_FoveSubmit);
+			FoveInvoke(EFoveApi::SubmitGroup, [&] { return Compositor->SubmitGroup(Infos.GetData(), Infos.Num()); });
+		}
+
+		// Mark the end of the GPU work that reads the slot, so it isn't copied over again until that has finished
+		if (Slot != INDEX_NONE)
+		{
+			Context->End(SwapChainQueries[Slot]);
+			SwapChainQueryIssued[Slot] = true;
+		}
+
+		// Restore state
+		if (Context)
+			SavedState.Restore(Context);
+
+		// Returning false skips the normal present of the desktop window
+		// Mirroring is decided again for each frame, so this goes back to presenting unless told otherwise
+		const bool bPresent = bPresentWindow;
+		bPresentWindow = true;
+		return bPresent;
+	}
+
+	void SetCompositorLayer(const Fove::SFVR_CompositorLayer& Layer) override
+	{
+		check(IsInRenderingThread());
+		FoveCompositorLayer = Layer;
+	}
+
+	void SetSubmitTexture(const FTexture2DRHIRef& Texture) override
+	{
+		check(IsInRenderingThread());
+		SubmitTextureOverride = Texture;
+	}
+
+private:
+
+	// Copies Source (the viewport render target, or the texture set via SetSubmitTexture) into the next texture of the swap chain, and returns that texture for submission
+	// The copy is queued on the GPU like any other work, so Unreal can render the next frame into the source straight away
+	// while the compositor is still reading this one. Returns the source itself if the swap chain is disabled or unavailable
+	// OutSlot is set to the index of the texture used, or INDEX_NONE if it is the source
+	ID3D11Texture2D* CopyToSwapChain(ID3D11Device* const Dev, ID3D11DeviceContext* const Ctx, ID3D11Texture2D* const Source, int32& OutSlot)
+	{
+		OutSlot = INDEX_NONE;
+		const int32 Depth = FMath::Min(CVarFoveSwapChainDepth.GetValueOnRenderThread(), MaxSwapChainDepth);
+		if (Depth < 2 || !Dev || !Ctx)
+		{
+			ReleaseSwapChain();
+			return Source;
+		}
+
+		// (Re)create the swap chain to match the source whenever either changes
+		D3D11_TEXTURE2D_DESC Desc;
+		Source->GetDesc(&Desc);
+		if (Depth != SwapChainDepth || FMemory::Memcmp(&Desc, &SwapChainDesc, sizeof(Desc)) != 0)
+		{
+			ReleaseSwapChain();
+			SwapChainDepth = Depth;
+			SwapChainDesc = Desc;
+
+			D3D11_QUERY_DESC QueryDesc = {};
+			QueryDesc.Query = D3D11_QUERY_EVENT;
+			for (int32 i = 0; i < Depth; ++i)
+			{
+				if (FAILED(Dev->CreateTexture2D(&Desc, nullptr, &SwapChainTextures[i])) || FAILED(Dev->CreateQuery(&QueryDesc, &SwapChainQueries[i])))
+				{
+					// Leave the swap chain empty, so this isn't retried every frame until the render target or setting changes
+					UE_LOG(LogHMD, Warning, TEXT("Failed to create the FOVE swap chain, submitting directly"));
+					ReleaseSwapChainTextures();
+					break;
+				}
+			}
+		}
+
+		ID3D11Texture2D* const Texture = SwapChainTextures[SwapChainIndex];
+		if (!Texture)
+			return Source;
+
+		// Wait for the GPU to finish with the last submit of this slot before copying over it
+		// With a deep enough swap chain that submit is a few frames old and this returns straight away
+		const int32 Slot = SwapChainIndex;
+		if (SwapChainQueryIssued[Slot])
+		{
+			SCOPE_CYCLE_COUNTER(STAT_FoveSwapChainWait);
+			while (Ctx->GetData(SwapChainQueries[Slot], nullptr, 0, 0) == S_FALSE)
+				FPlatformProcess::Sleep(0.0f);
+			SwapChainQueryIssued[Slot] = false;
+		}
+
+		OutSlot = Slot;
+		SwapChainIndex = (SwapChainIndex + 1) % SwapChainDepth;
+		Ctx->CopyResource(Texture, Source);
+		return Texture;
+	}
+
+	void ReleaseSwapChainTextures()
+	{
+		for (int32 i = 0; i < MaxSwapChainDepth; ++i)
+		{
+			if (SwapChainTextures[i])
+			{
+				SwapChainTextures[i]->Release();
+				SwapChainTextures[i] = nullptr;
+			}
+
+			if (SwapChainQueries[i])
+			{
+				SwapChainQueries[i]->Release();
+				SwapChainQueries[i] = nullptr;
+			}
+			SwapChainQueryIssued[i] = false;
+		}
+		SwapChainIndex = 0;
+	}
+
+	void ReleaseDevice()
+	{
+		if (Context)
+		{
+			Context->Release();
+			Context = nullptr;
+		}
+
+		if (Device)
+		{
+			Device->Release();
+			Device = nullptr;
+		}
+	}
+
+	void ReleaseSwapChain()
+	{
+		ReleaseSwapChainTextures();
+		SwapChainDepth = 0;
+		FMemory::Memzero(SwapChainDesc);
+	}
+
+public:
+
+	void UpdateViewport(const FViewport& Viewport) override
+	{
+		check(IsInGameThread());
+
+		// Present reads the render target, device and context on the render thread, so they are swapped over there
+		// The command holds a reference to the RHI texture, which keeps the native texture alive until then
+		const FTexture2DRHIRef TextureRef = Viewport.GetRenderTargetTexture();
+		const TRefCountPtr<FoveD3D11Bridge> BridgeRef = this;
+		const TFunction<void()> SetRenderTargetCommand = [BridgeRef, TextureRef]()
+		{
+			BridgeRef->SetRenderTarget(TextureRef);
+		};
+
+		ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+			FoveSetRenderTarget,
+			TFunction<void()>, Command, SetRenderTargetCommand,
+			{
+				Command();
+			});
+	}
+
+private:
+
+	void SetRenderTarget(const FTexture2DRHIRef& TextureRef)
+	{
+		check(IsInRenderingThread());
+
+		ID3D11Texture2D* const newRT = TextureRef ? (ID3D11Texture2D*)TextureRef->GetNativeResource() : nullptr;
+		if (newRT != RenderTargetTexture)
+		{
+			if (RenderTargetTexture)
+				RenderTargetTexture->Release();
+
+			RenderTargetTexture = newRT;
+			
+			if (RenderTargetTexture)
+				RenderTargetTexture->AddRef();
+
+			// GetDevice and GetImmediateContext each add a reference, which are held until the render target changes again
+			ReleaseDevice();
+			if (RenderTargetTexture)
+			{
+				RenderTargetTexture->GetDevice(&Device);
+				if (Device)
+					Device->GetImmediateContext(&Context);
+			}
+		}
+	}
+
+public:
+
+#if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 18
+	bool NeedsNativePresent() override
+	{
+		return true;
+	}
+#endif
+};
+
+#endif // PLATFORM_WINDOWS
+
+#ifdef _MSC_VER
+#pragma endregion
+#endif
+
+//---------------------------------------------------
+// FFoveGazeClassifier
+//---------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma region FFoveGazeClassifier
+#else
+#pragma mark FFoveGazeClassifier
+#endif
+
+// Streaming eye movement classifier, fed with every sample by the gaze sampler at the eye tracker's native rate
+// Classification is velocity threshold based (I-VT), with a minimum duration for fixations to reject noise
+// Samples are kept in a small structure-of-arrays window, so the velocity pass is a straight loop over contiguous floats that vectorizes
+// Each sample is labelled as it arrives, so an event is published as soon as the sample that ends it is seen
+class FFoveGazeClassifier
+{
+public:
+
+	// Adds a sample to the window and classifies it
+	void AddSample(const FFoveGazeSample& Sample)
+	{
+		// Use the cyclopean gaze direction, falling back to a single eye when the other is closed
+		const bool bLeftClosed = Sample.EyesClosed == Fove::EFVR_Eye::Left || Sample.EyesClosed == Fove::EFVR_Eye::Both;
+		const bool bRightClosed = Sample.EyesClosed == Fove::EFVR_Eye::Right || Sample.EyesClosed == Fove::EFVR_Eye::Both;
+		FVector Direction(0.0f, 0.0f, 0.0f);
+		if (!bLeftClosed)
+			Direction += FVector(Sample.LeftGaze.vector.x, Sample.LeftGaze.vector.y, Sample.LeftGaze.vector.z);
+		if (!bRightClosed)
+			Direction += FVector(Sample.RightGaze.vector.x, Sample.RightGaze.vector.y, Sample.RightGaze.vector.z);
+		Direction = Direction.GetSafeNormal();
+
+		// A timestamp that went backwards (eg. after a reconnect) can't be compared with anything before it, so start a new window
+		// A segment can't span time going backwards either, so drop whatever was being built up and start again from here
+		const uint64 Timestamp = Sample.LeftGaze.timestamp;
+		if (Count > 0 && Timestamp < Timestamps[Count - 1])
+			Count = NumClassified = 0;
+		if (bInSegment && Timestamp < Segment.StartTime)
+			bInSegment = false;
+
+		// Once the window is full, start a new one from the last sample so velocities carry over
+		if (Count == WindowCapacity)
+			Slide();
+
+		Timestamps[Count] = Timestamp;
+		DirX[Count] = Direction.X;
+		DirY[Count] = Direction.Y;
+		DirZ[Count] = Direction.Z;
+		Sources[Count] = (bLeftClosed ? 0 : 1) | (bRightClosed ? 0 : 2);
+		Closed[Count] = bLeftClosed && bRightClosed;
+		++Count;
+
+		UpdateVelocities();
+		ClassifyPending();
+	}
+
+	uint64 ReadSince(const uint64 EventId, TArray<FFoveGazeEvent>& OutEvents) const
+	{
+		return Events.ReadSince(EventId, OutEvents);
+	}
+
+private:
+
+	// Works out the angular velocity of every sample that hasn't been classified yet, in degrees per second
+	void UpdateVelocities()
+	{
+		// Convert timestamps to seconds relative to the start of the window, so the loop below can stay in floats
+		const uint64 BaseTimestamp = Timestamps[0];
+		for (int32 i = NumClassified; i < Count; ++i)
+			Time[i] = static_cast<float>(Timestamps[i] - BaseTimestamp) * 0.001f;
+
+		// The chord between unit vectors is used as the angle
+		// This is accurate to well under a percent at the angles seen between consecutive samples, and unlike acos it vectorizes
+		// There is no velocity across a discontinuity: the first sample of the window, a repeated timestamp, a change of which eyes the direction
+		// comes from (switching between the cyclopean and a single eye's direction jumps by the vergence angle and would look like a saccade),
+		// or either side of a blink
+		if (NumClassified == 0)
+			Velocity[0] = 0.0f;
+		for (int32 i = FMath::Max(NumClassified, 1); i < Count; ++i)
+		{
+			const float DX = DirX[i] - DirX[i - 1];
+			const float DY = DirY[i] - DirY[i - 1];
+			const float DZ = DirZ[i] - DirZ[i - 1];
+			const float Dt = FMath::Max(Time[i] - Time[i - 1], 0.0001f);
+			const bool bContinuous = Time[i] > Time[i - 1] && Sources[i] == Sources[i - 1] && !Closed[i - 1] && !Closed[i];
+			Velocity[i] = bContinuous ? FMath::Sqrt(DX * DX + DY * DY + DZ * DZ) * (180.0f / PI) / Dt : 0.0f;
+		}
+	}
+
+	// Labels every sample that hasn't been classified yet, publishing the events they end
+	void ClassifyPending()
+	{
+		const float SaccadeVelocity = CVarFoveSaccadeVelocity.GetValueOnAnyThread();
+		for (int32 i = NumClassified; i < Count; ++i)
+		{
+			EFoveGazeEventType Type = EFoveGazeEventType::Fixation;
+			if (Closed[i])
+				Type = EFoveGazeEventType::Blink;
+			else if (Velocity[i] > SaccadeVelocity)
+				Type = EFoveGazeEventType::Saccade;
+
+			ProcessSample(i, Type);
+		}
+		NumClassified = Count;
+	}
+
+	// Moves the last sample to the start of the window, dropping the rest
+	void Slide()
+	{
+		const int32 Last = Count - 1;
+		Timestamps[0] = Timestamps[Last];
+		Time[0] = 0.0f;
+		DirX[0] = DirX[Last];
+		DirY[0] = DirY[Last];
+		DirZ[0] = DirZ[Last];
+		Velocity[0] = Velocity[Last];
+		Sources[0] = Sources[Last];
+		Closed[0] = Closed[Last];
+		Count = NumClassified = 1;
+	}
+
+	void ProcessSample(const int32 Index, const EFoveGazeEventType Type)
+	{
+		// Segments are contiguous, so each one ends where the next one starts
+		if (bInSegment && Type != Segment.Type)
+			EndSegment(Timestamps[Index]);
+
+		if (!bInSegment)
+		{
+			bInSegment = true;
+			Segment = FFoveGazeEvent();
+			Segment.Type = Type;
+			Segment.StartTime = Timestamps[Index];
+			SegmentDirectionSum = FVector(0.0f, 0.0f, 0.0f);
+		}
+
+		Segment.EndTime = Timestamps[Index];
+		if (Type != EFoveGazeEventType::Blink)
+		{
+			SegmentDirectionSum += FVector(DirX[Index], DirY[Index], DirZ[Index]);
+			Segment.PeakVelocity = FMath::Max(Segment.PeakVelocity, Velocity[Index]);
+		}
+	}
+
+	void EndSegment(const uint64 EndTime)
+	{
+		bInSegment = false;
+
+		// Timestamps are unsigned, so check the order before taking the duration
+		if (EndTime < Segment.StartTime)
+			return;
+		Segment.EndTime = EndTime;
+
+		// Drop fixations too short to be real, these are generally noise between two saccades
+		if (Segment.Type == EFoveGazeEventType::Fixation && Segment.EndTime - Segment.StartTime < static_cast<uint64>(CVarFoveMinFixationDuration.GetValueOnAnyThread()))
+			return;
+
+		const FVector Centroid = SegmentDirectionSum.GetSafeNormal();
+		Segment.Centroid = ToUnreal(Fove::SFVR_Vec3(Centroid.X, Centroid.Y, Centroid.Z), 1.0f);
+		Segment.Id = Events.GetLatestSequence() + 1;
+		Events.Push(Segment);
+	}
+
+	static const int32 WindowCapacity = 16;
+
+	// Recent samples, in structure-of-arrays form
+	uint64 Timestamps[WindowCapacity];
+	float Time[WindowCapacity];
+	float DirX[WindowCapacity];
+	float DirY[WindowCapacity];
+	float DirZ[WindowCapacity];
+	float Velocity[WindowCapacity];
+	uint8 Sources[WindowCapacity]; // Bit 0 if the left eye contributed to the direction, bit 1 for the right eye
+	bool Closed[WindowCapacity];
+	int32 Count = 0;
+	int32 NumClassified = 0; // Samples at the start of the window that have already been classified
+
+	// Event currently being built up
+	FFoveGazeEvent Segment;
+	FVector SegmentDirectionSum = FVector(0.0f, 0.0f, 0.0f);
+	bool bInSegment = false;
+
+	// Finished events, for other threads to read
+	TFoveSampleRing<FFoveGazeEvent, 256> Events;
+};
+
+#ifdef _MSC_VER
+#pragma endregion
+#endif
+
+//---------------------------------------------------
+// FFoveGazeFilter
+//---------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma region FFoveGazeFilter
+#else
+#pragma mark FFoveGazeFilter
+#endif
+
+// One Euro filter (Casiez et al. 2012) for a 3D vector
+// This is a low pass filter whose cutoff frequency rises with the speed of the input,
+// which removes jitter while the input is still without adding noticeable lag when it moves quickly
+struct FFoveOneEuroFilter
+{
+	FVector Value = FVector::ZeroVector;
+	FVector Derivative = FVector::ZeroVector;
+	bool bInitialized = false;
+
+	void Reset()
+	{
+		bInitialized = false;
+	}
+
+	FVector Filter(const FVector& Input, const float DeltaTime, const float MinCutoff, const float Beta, const float DerivativeCutoff)
+	{
+		if (!bInitialized || DeltaTime <= 0.0f)
+		{
+			Value = Input;
+			Derivative = FVector::ZeroVector;
+			bInitialized = true;
+			return Value;
+		}
+
+		Derivative = FMath::Lerp(Derivative, (Input - Value) / DeltaTime, Alpha(DerivativeCutoff, DeltaTime));
+		const float Cutoff = MinCutoff + Beta * Derivative.Size();
+		Value = FMath::Lerp(Value, Input, Alpha(Cutoff, DeltaTime));
+		return Value;
+	}
+
+	static float Alpha(const float Cutoff, const float DeltaTime)
+	{
+		const float Tau = 1.0f / (2.0f * PI * FMath::Max(Cutoff, 0.001f));
+		return 1.0f / (1.0f + Tau / DeltaTime);
+	}
+};
+
+// Applies the built-in gaze filter to each new sample, see fove.GazeFilter
+// One filter is kept per eye, plus one for the convergence ray, and each is reset whenever its data becomes invalid
+class FFoveGazeFilter
+{
+public:
+
+	void Apply(FFoveGazeSample& Sample)
+	{
+		const bool bEnabled = CVarFoveGazeFilter.GetValueOnAnyThread() != 0;
+		const float MinCutoff = CVarFoveGazeFilterMinCutoff.GetValueOnAnyThread();
+		const float Beta = CVarFoveGazeFilterBeta.GetValueOnAnyThread();
+		const float DerivativeCutoff = CVarFoveGazeFilterDerivativeCutoff.GetValueOnAnyThread();
+
+		// Gaps longer than this (eg. a stall in the sampler) would make the filter swing, so start over instead
+		const float DeltaTime = LastTimestamp != 0 ? (Sample.LeftGaze.timestamp - LastTimestamp) * 0.001f : 0.0f;
+		LastTimestamp = Sample.LeftGaze.timestamp;
+		if (!bEnabled || DeltaTime > 0.5f)
+		{
+			Left.Reset();
+			Right.Reset();
+			Convergence.Reset();
+		}
+
+		const bool bLeftClosed = Sample.EyesClosed == Fove::EFVR_Eye::Left || Sample.EyesClosed == Fove::EFVR_Eye::Both;
+		const bool bRightClosed = Sample.EyesClosed == Fove::EFVR_Eye::Right || Sample.EyesClosed == Fove::EFVR_Eye::Both;
+
+		Sample.FilteredLeftGaze = ApplyDirection(Left, Sample.LeftGaze.vector, bEnabled && !bLeftClosed, DeltaTime, MinCutoff, Beta, DerivativeCutoff);
+		Sample.FilteredRightGaze = ApplyDirection(Right, Sample.RightGaze.vector, bEnabled && !bRightClosed, DeltaTime, MinCutoff, Beta, DerivativeCutoff);
+
+		// For convergence, the direction and distance are filtered together so the convergence point moves smoothly
+		Sample.FilteredConvergence = Sample.Convergence;
+		if (bEnabled && Sample.bConvergenceValid)
+		{
+			const Fove::SFVR_Vec3& Dir = Sample.Convergence.ray.direction;
+			const FVector Point = FVector(Dir.x, Dir.y, Dir.z).GetSafeNormal() * Sample.Convergence.distance;
+			const FVector Filtered = Convergence.Filter(Point, DeltaTime, MinCutoff, Beta, DerivativeCutoff);
+			const FVector FilteredDir = Filtered.GetSafeNormal();
+			Sample.FilteredConvergence.ray.direction = Fove::SFVR_Vec3(FilteredDir.X, FilteredDir.Y, FilteredDir.Z);
+			Sample.FilteredConvergence.distance = Filtered.Size();
+		}
+		else
+		{
+			Convergence.Reset();
+		}
+	}
+
+private:
+
+	static Fove::SFVR_Vec3 ApplyDirection(FFoveOneEuroFilter& Filter, const Fove::SFVR_Vec3& Raw, const bool bApply, const float DeltaTime, const float MinCutoff, const float Beta, const float DerivativeCutoff)
+	{
+		if (!bApply)
+		{
+			Filter.Reset();
+			return Raw;
+		}
+
+		const FVector Filtered = Filter.Filter(FVector(Raw.x, Raw.y, Raw.z), DeltaTime, MinCutoff, Beta, DerivativeCutoff).GetSafeNormal();
+		return Fove::SFVR_Vec3(Filtered.X, Filtered.Y, Filtered.Z);
+	}
+
+	FFoveOneEuroFilter Left;
+	FFoveOneEuroFilter Right;
+	FFoveOneEuroFilter Convergence;
+	uint64 LastTimestamp = 0;
+};
+
+#ifdef _MSC_VER
+#pragma endregion
+#endif
+
+//---------------------------------------------------
+// FFoveEyeStateTracker
+//---------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma region FFoveEyeStateTracker
+#else
+#pragma mark FFoveEyeStateTracker
+#endif
+
+// Detects blinks and tracking changes of each eye from the full rate sample stream
+// Only transitions are recorded, so readers get one event per change rather than having to poll the state and compare
+// AddSample must only be called from the sampler thread, while ReadSince may be called from any thread
+class FFoveEyeStateTracker
+{
+public:
+
+	void AddSample(const FFoveGazeSample& Sample)
+	{
+		if (Sample.bEyesClosedValid)
+		{
+			UpdateState(EFoveEye::Left, Eyes[0].Closed, IsEyeInSet(Sample.EyesClosed, false), Sample.LeftGaze.timestamp, EFoveEyeStateChange::BlinkStarted, EFoveEyeStateChange::BlinkEnded);
+			UpdateState(EFoveEye::Right, Eyes[1].Closed, IsEyeInSet(Sample.EyesClosed, true), Sample.RightGaze.timestamp, EFoveEyeStateChange::BlinkStarted, EFoveEyeStateChange::BlinkEnded);
+		}
+
+		// Tracking is stored as "lost" so that both kinds of state start an interval when they become true
+		if (Sample.bEyesTrackedValid)
+		{
+			UpdateState(EFoveEye::Left, Eyes[0].Lost, !IsEyeInSet(Sample.EyesTracked, false), Sample.LeftGaze.timestamp, EFoveEyeStateChange::TrackingLost, EFoveEyeStateChange::TrackingAcquired);
+			UpdateState(EFoveEye::Right, Eyes[1].Lost, !IsEyeInSet(Sample.EyesTracked, true), Sample.RightGaze.timestamp, EFoveEyeStateChange::TrackingLost, EFoveEyeStateChange::TrackingAcquired);
+		}
+	}
+
+	uint64 ReadSince(const uint64 EventId, TArray<FFoveEyeStateEvent>& OutEvents) const
+	{
+		return Events.ReadSince(EventId, OutEvents);
+	}
+
+private:
+
+	struct FState
+	{
+		bool bKnown = false;  // False until the first valid sample, which sets the baseline without firing an event
+		bool bActive = false; // Whether the eye is currently closed (or lost)
+		uint64 Since = 0;     // Eye tracker timestamp at which bActive last became true
+	};
+
+	struct FEyeState
+	{
+		FState Closed;
+		FState Lost;
+	};
+
+	static bool IsEyeInSet(const Fove::EFVR_Eye Set, const bool bRightEye)
+	{
+		return Set == Fove::EFVR_Eye::Both || Set == (bRightEye ? Fove::EFVR_Eye::Right : Fove::EFVR_Eye::Left);
+	}
+
+	void UpdateState(const EFoveEye Eye, FState& State, const bool bActive, const uint64 Timestamp, const EFoveEyeStateChange StartChange, const EFoveEyeStateChange EndChange)
+	{
+		const bool bChanged = State.bKnown && State.bActive != bActive;
+		const uint64 Since = State.Since;
+		if (!State.bKnown || bChanged)
+		{
+			State.bKnown = true;
+			State.bActive = bActive;
+			State.Since = Timestamp;
+		}
+
+		if (!bChanged)
+			return;
+
+		FFoveEyeStateEvent Event;
+		Event.Id = Events.GetLatestSequence() + 1;
+		Event.Eye = Eye;
+		Event.Change = bActive ? StartChange : EndChange;
+		Event.Timestamp = Timestamp;
+		if (!bActive && Timestamp > Since)
+			Event.Duration = (Timestamp - Since) * 0.001f;
+		Events.Push(Event);
+	}
+
+	FEyeState Eyes[2];
+
+	// Blinks are a few per second at most, so this covers far longer than a frame
+	TFoveSampleRing<FFoveEyeStateEvent, 64> Events;
+};
+
+#ifdef _MSC_VER
+#pragma endregion
+#endif
+
+//---------------------------------------------------
+// FFoveGazeSampler
+//---------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma region FFoveGazeSampler
+#else
+#pragma mark FFoveGazeSampler
+#endif
+
+// Background thread that polls the eye tracker at its native rate, which is higher than the game's frame rate
+// Each new sample is pushed into a ring buffer that other threads can read from without locking
+class FFoveGazeSampler : public FRunnable
+{
+public:
+
+	FFoveGazeSampler(const TSharedRef<Fove::IFVRHeadset, ESPMode::ThreadSafe>& headset)
+		: Headset(headset)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("FoveGazeSampler"), 0, TPri_AboveNormal);
+	}
+
+	~FFoveGazeSampler()
+	{
+		if (Thread)
+		{
+			Thread->Kill(true);
+			delete Thread;
+		}
+	}
+
+	bool ReadLatest(FFoveGazeSample& OutSample) const
+	{
+		return bLastPollSucceeded && Samples.ReadLatest(OutSample);
+	}
+
+	uint64 ReadSince(const uint64 SampleId, TArray<FFoveGazeSample>& OutSamples) const
+	{
+		return Samples.ReadSince(SampleId, OutSamples);
+	}
+
+	uint64 ReadEventsSince(const uint64 EventId, TArray<FFoveGazeEvent>& OutEvents) const
+	{
+		return Classifier.ReadSince(EventId, OutEvents);
+	}
+
+	uint64 ReadEyeStateEventsSince(const uint64 EventId, TArray<FFoveEyeStateEvent>& OutEvents) const
+	{
+		return EyeStateTracker.ReadSince(EventId, OutEvents);
+	}
+
+public: // FRunnable interface
+
+	uint32 Run() override
+	{
+		uint64 LastLeftId = 0;
+		uint64 LastRightId = 0;
+
+		while (!bStopping)
+		{
+			FFoveGazeSample Sample;
+			const Fove::EFVR_ErrorCode Error = FoveInvoke(EFoveApi::GetGazeVectors, [&] { return Headset->GetGazeVectors(&Sample.LeftGaze, &Sample.RightGaze); }, EFoveInvoke::Sampler);
+			bLastPollSucceeded = Error == Fove::EFVR_ErrorCode::None;
+
+			// The service keeps returning the last sample until the eye tracker produces a new one
+			if (bLastPollSucceeded && (Sample.LeftGaze.id != LastLeftId || Sample.RightGaze.id != LastRightId))
+			{
+				LastLeftId = Sample.LeftGaze.id;
+				LastRightId = Sample.RightGaze.id;
+
+				Sample.bConvergenceValid = FoveInvoke(EFoveApi::GetGazeConvergence, [&] { return Headset->GetGazeConvergence(&Sample.Convergence); }, EFoveInvoke::Sampler) == Fove::EFVR_ErrorCode::None;
+				Sample.bEyesClosedValid = FoveInvoke(EFoveApi::CheckEyesClosed, [&] { return Headset->CheckEyesClosed(&Sample.EyesClosed); }, EFoveInvoke::Sampler) == Fove::EFVR_ErrorCode::None;
+				Sample.bEyesTrackedValid = FoveInvoke(EFoveApi::CheckEyesTracked, [&] { return Headset->CheckEyesTracked(&Sample.EyesTracked); }, EFoveInvoke::Sampler) == Fove::EFVR_ErrorCode::None;
+				Sample.ReceiveTime = FPlatformTime::Seconds();
+				Sample.Id = Samples.GetLatestSequence() + 1;
+				Filter.Apply(Sample);
+				Samples.Push(Sample);
+
+				Classifier.AddSample(Sample);
+				EyeStateTracker.AddSample(Sample);
+			}
 
-			RenderTargetTexture = newRT;
-			
-			if (RenderTargetTexture)
-				RenderTargetTexture->AddRef();
+			const float PollIntervalMs = FMath::Max(CVarFoveGazePollInterval.GetValueOnAnyThread(), 0.1f);
+			FPlatformProcess::Sleep(PollIntervalMs / 1000.0f);
 		}
+
+		return 0;
 	}
 
-#if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 18
-	bool NeedsNativePresent() override
+	void Stop() override
 	{
-		return true;
+		bStopping = true;
 	}
-#endif
-};
 
-#endif // PLATFORM_WINDOWS
+private:
+
+	const TSharedRef<Fove::IFVRHeadset, ESPMode::ThreadSafe> Headset;
+	FRunnableThread* Thread = nullptr;
+
+	// Roughly four seconds of history at 120Hz
+	TFoveSampleRing<FFoveGazeSample, 512> Samples;
+
+	// Only accessed from the sampler thread, apart from reading finished events
+	FFoveGazeFilter Filter;
+	FFoveGazeClassifier Classifier;
+	FFoveEyeStateTracker EyeStateTracker;
+
+	volatile bool bLastPollSucceeded = false;
+	volatile bool bStopping = false;
+};
 
 #ifdef _MSC_VER
 #pragma endregion
@@ -337,7 +2295,7 @@ bool UFoveVRFunctionLibrary::IsEyeTrackingCalibrating()
 {
 	if (FFoveHMD* const hmd = FFoveHMD::Get())
 	{
-		hmd->GetHeadset().EnsureEyeTrackingCalibration();
+		hmd->EnsureEyeTrackingCalibration();
 		return true;
 	}
 
@@ -368,6 +2326,22 @@ bool UFoveVRFunctionLibrary::GetGazeVector(const bool bRelativeToHMD, FVector& o
 	return false;
 }
 
+bool UFoveVRFunctionLibrary::GetRawGazeConvergence(const bool bRelativeToHMD, FVector& outRayOrigin, FVector& outRayDirection, float& outDistance, float& outAccuracy)
+{
+	if (FFoveHMD* const hmd = FFoveHMD::Get())
+		return hmd->GetRawGazeConvergence(bRelativeToHMD, &outRayOrigin, &outRayDirection, &outDistance, &outAccuracy);
+
+	return false;
+}
+
+bool UFoveVRFunctionLibrary::GetRawGazeVector(const bool bRelativeToHMD, FVector& outLeft, FVector& outRight)
+{
+	if (FFoveHMD* const hmd = FFoveHMD::Get())
+		return hmd->GetRawGazeVector(bRelativeToHMD, &outLeft, &outRight);
+
+	return false;
+}
+
 bool UFoveVRFunctionLibrary::GetGazeVector2D(FVector2D& outLeft, FVector2D& outRight)
 {
 	if (FFoveHMD* const hmd = FFoveHMD::Get())
@@ -409,14 +2383,340 @@ bool UFoveVRFunctionLibrary::IsPositionReady()
 
 	if (FFoveHMD* const hmd = FFoveHMD::Get())
 	{
-		const Fove::EFVR_ErrorCode Error = hmd->GetHeadset().IsPositionReady(&Ret);
-		if (Error != Fove::EFVR_ErrorCode::None)
-			UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::IsPositionReady failed: %d"), static_cast<int>(Error));
+		Ret = hmd->IsPositionReady();
 	}
 
 	return Ret;
 }
 
+int32 UFoveVRFunctionLibrary::CreateOverlayLayer(const bool bFixedToHMD)
+{
+	if (FFoveHMD* const hmd = FFoveHMD::Get())
+		return hmd->CreateOverlayLayer(bFixedToHMD);
+
+	return 0;
+}
+
+bool UFoveVRFunctionLibrary::SetOverlayLayerTexture(const int32 OverlayId, UTextureRenderTarget2D* const RenderTarget, const FVector2D LeftMin, const FVector2D LeftMax, const FVector2D RightMin, const FVector2D RightMax)
+{
+	if (FFoveHMD* const hmd = FFoveHMD::Get())
+		return hmd->SetOverlayLayerTexture(OverlayId, RenderTarget, FBox2D(LeftMin, LeftMax), FBox2D(RightMin, RightMax));
+
+	return false;
+}
+
+bool UFoveVRFunctionLibrary::GetFoveationInset(const bool bRightEye, FVector2D& outMin, FVector2D& outMax)
+{
+	FBox2D Inset;
+	if (FFoveHMD* const hmd = FFoveHMD::Get())
+	{
+		if (hmd->GetFoveationInset(bRightEye, Inset))
+		{
+			outMin = Inset.Min;
+			outMax = Inset.Max;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#ifdef _MSC_VER
+#pragma endregion
+#endif
+
+//---------------------------------------------------
+// UFoveEyeTrackingComponent
+//---------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma region UFoveEyeTrackingComponent
+#else
+#pragma mark UFoveEyeTrackingComponent
+#endif
+
+UFoveEyeTrackingComponent::UFoveEyeTrackingComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, Eye(EFoveEye::Left)
+	, bUseFilteredGaze(true)
+	, bLateUpdate(true)
+	, bIsTracked(false)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+	bAutoActivate = true;
+}
+
+void UFoveEyeTrackingComponent::TickComponent(const float DeltaTime, const ELevelTick TickType, FActorComponentTickFunction* const ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// This reads the gaze snapshot for the frame, so any number of these components only costs one query of the eye tracker
+	FTransform Transform;
+	FFoveHMD* const hmd = FFoveHMD::Get();
+	bIsTracked = hmd && hmd->GetEyeRelativeTransform(Eye == EFoveEye::Right, bUseFilteredGaze, Transform);
+	if (bIsTracked)
+		SetRelativeLocationAndRotation(Transform.GetLocation(), Transform.GetRotation());
+}
+
+void UFoveEyeTrackingComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	if (FFoveHMD* const hmd = FFoveHMD::Get())
+		hmd->RegisterEyeTrackingComponent(this);
+}
+
+void UFoveEyeTrackingComponent::OnUnregister()
+{
+	if (FFoveHMD* const hmd = FFoveHMD::Get())
+		hmd->UnregisterEyeTrackingComponent(this);
+
+	Super::OnUnregister();
+}
+
+#ifdef _MSC_VER
+#pragma endregion
+#endif
+
+//---------------------------------------------------
+// FFoveHealthMonitor
+//---------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma region FFoveHealthMonitor
+#else
+#pragma mark FFoveHealthMonitor
+#endif
+
+// Background thread which polls the health of the FOVE system at a low rate, see fove.HealthPollInterval
+// The result is published as a single packed word, so connection checks on the game and render threads never wait on the FOVE service
+// When the headset becomes ready again after dropping out, this re-creates the compositor layer (the service forgets it when restarted,
+// and a different headset may want a different resolution) and bumps the connection generation so that FFoveHMD refreshes its caches
+// Overlay layers are created here as well, always after the base layer, so the game thread never makes compositor calls for layers
+// and only picks up the results whenever the layer revision changes
+class FFoveHealthMonitor : public FRunnable
+{
+public:
+
+	FFoveHealthMonitor(const TSharedRef<Fove::IFVRHeadset, ESPMode::ThreadSafe>& headset, const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe>& compositor, const Fove::SFVR_CompositorLayer& layer)
+		: Headset(headset)
+		, Compositor(compositor)
+		, Layer(layer)
+	{
+		// Poll once before the thread starts, so the state is never reported as anything other than what the service says
+		const FFoveSystemState State = Poll();
+		PackedState = State.Pack();
+		bInitiallyReady = State.HMD == EFoveConnectionState::Ready;
+
+		WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+		Thread = FRunnableThread::Create(this, TEXT("FoveHealthMonitor"), 0, TPri_BelowNormal);
+	}
+
+	~FFoveHealthMonitor()
+	{
+		if (Thread)
+		{
+			Thread->Kill(true);
+			delete Thread;
+		}
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	}
+
+	FFoveSystemState GetState() const
+	{
+		return FFoveSystemState::Unpack(PackedState);
+	}
+
+	// Requests an overlay layer, which is created on the monitor thread as soon as the headset is ready, and again after each reconnect
+	// Returns the slot of the layer, which is the index of its entry in the array returned by GetLayers
+	int32 AddOverlayLayer(const Fove::SFVR_CompositorLayerCreateInfo& CreateInfo)
+	{
+		int32 Slot;
+		{
+			FScopeLock Lock(&LayerLock);
+			Slot = OverlayCreateInfos.Add(CreateInfo);
+			OverlayLayers.AddDefaulted();
+		}
+		WakeEvent->Trigger();
+		return Slot;
+	}
+
+	// Returns a number which changes whenever any of the layers returned by GetLayers changes
+	int32 GetLayerRevision() const
+	{
+		return LayerRevision;
+	}
+
+	// Returns the compositor layer created for the latest connection generation, along with the overlay layers
+	// Overlay layers which haven't been created yet have a layerId of 0
+	void GetLayers(Fove::SFVR_CompositorLayer& OutLayer, TArray<Fove::SFVR_CompositorLayer>& OutOverlayLayers) const
+	{
+		FScopeLock Lock(&LayerLock);
+		OutLayer = Layer;
+		OutOverlayLayers = OverlayLayers;
+	}
+
+public: // FRunnable interface
+
+	uint32 Run() override
+	{
+		// The layer passed in was created before the first poll, so it only needs re-creating if the headset wasn't ready then
+		bool bWasReady = bInitiallyReady;
+		uint32 Generation = 0;
+
+		while (!bStopping)
+		{
+			FFoveSystemState State = Poll();
+			bool bReady = State.HMD == EFoveConnectionState::Ready;
+
+			if (bReady && !bWasReady)
+			{
+				// The new layer is stored before the new generation is published, so anyone who sees the generation also sees the layer
+				// Overlay layers went away along with the old base layer, so they are marked for creating again below
+				Fove::SFVR_CompositorLayer NewLayer;
+				if (FoveInvoke(EFoveApi::CreateLayer, [&] { return Compositor->CreateLayer(GetLayerCreateInfo(), &NewLayer); }, EFoveInvoke::Monitor) == Fove::EFVR_ErrorCode::None)
+				{
+					{
+						FScopeLock Lock(&LayerLock);
+						Layer = NewLayer;
+						for (Fove::SFVR_CompositorLayer& OverlayLayer : OverlayLayers)
+							OverlayLayer = Fove::SFVR_CompositorLayer();
+					}
+					FPlatformAtomics::InterlockedIncrement(&LayerRevision);
+					++Generation;
+					UE_LOG(LogHMD, Log, TEXT("FOVE headset reconnected"));
+				}
+				else
+				{
+					// Try again on the next poll
+					State.HMD = EFoveConnectionState::Connecting;
+					bReady = false;
+				}
+			}
+			else if (!bReady && bWasReady)
+			{
+				UE_LOG(LogHMD, Log, TEXT("FOVE headset disconnected"));
+			}
+			bWasReady = bReady;
+
+			if (bReady)
+				CreateOverlayLayers();
+
+			State.ConnectionGeneration = Generation;
+			FPlatformAtomics::InterlockedExchange(&PackedState, State.Pack());
+
+			const float PollInterval = FMath::Max(CVarFoveHealthPollInterval.GetValueOnAnyThread(), 0.05f);
+			WakeEvent->Wait(FTimespan::FromSeconds(PollInterval));
+		}
+
+		return 0;
+	}
+
+	void Stop() override
+	{
+		bStopping = true;
+		WakeEvent->Trigger();
+	}
+
+private:
+
+	static EFoveConnectionState ToConnectionState(const Fove::EFVR_HealthStatus Status)
+	{
+		switch (Status)
+		{
+		case Fove::EFVR_HealthStatus::Healthy:
+			return EFoveConnectionState::Ready;
+		case Fove::EFVR_HealthStatus::Uncalibrated:
+		case Fove::EFVR_HealthStatus::Error:
+			return EFoveConnectionState::Degraded;
+		case Fove::EFVR_HealthStatus::Disconnected:
+			return EFoveConnectionState::Disconnected;
+		case Fove::EFVR_HealthStatus::Unknown:
+		case Fove::EFVR_HealthStatus::Sleeping:
+		default:
+			return EFoveConnectionState::Connecting;
+		}
+	}
+
+	FFoveSystemState Poll()
+	{
+		// Everything is disconnected if the service can't be reached
+		FFoveSystemState State;
+		Fove::SFVR_SystemHealth Health;
+		if (FoveInvoke(EFoveApi::GetSystemHealth, [&] { return Headset->GetSystemHealth(&Health, false); }, EFoveInvoke::Monitor) != Fove::EFVR_ErrorCode::None)
+			return State;
+
+		State.HMD = ToConnectionState(Health.HMD);
+		State.EyeCamera = ToConnectionState(Health.EyeCamera);
+		State.PositionCamera = ToConnectionState(Health.PositionCamera);
+		State.EyeLEDs = ToConnectionState(Health.EyeLEDs);
+		State.PositionLEDs = ToConnectionState(Health.PositionLEDs);
+
+		// Only use the headset once the FOVE compositor is running, since other plugins (such as SteamVR and OSVR) may also drive it
+		if (State.HMD == EFoveConnectionState::Ready)
+		{
+			bool bCompositorReady = false;
+			FoveInvoke(EFoveApi::IsReady, [&] { return Compositor->IsReady(&bCompositorReady); }, EFoveInvoke::Monitor);
+			if (!bCompositorReady)
+				State.HMD = EFoveConnectionState::Connecting;
+		}
+
+		return State;
+	}
+
+	// Creates any overlay layers which were requested or lost since the last poll, see AddOverlayLayer
+	// Failures are left for the next poll to try again
+	void CreateOverlayLayers()
+	{
+		TArray<Fove::SFVR_CompositorLayerCreateInfo> CreateInfos;
+		TArray<int32> Slots;
+		{
+			FScopeLock Lock(&LayerLock);
+			for (int32 Slot = 0; Slot < OverlayLayers.Num(); ++Slot)
+			{
+				if (OverlayLayers[Slot].layerId == 0)
+				{
+					CreateInfos.Add(OverlayCreateInfos[Slot]);
+					Slots.Add(Slot);
+				}
+			}
+		}
+
+		// Slots are never removed, so they are still valid after the lock is released
+		bool bCreated = false;
+		for (int32 Index = 0; Index < Slots.Num(); ++Index)
+		{
+			Fove::SFVR_CompositorLayer NewLayer;
+			if (FoveInvoke(EFoveApi::CreateLayer, [&] { return Compositor->CreateLayer(CreateInfos[Index], &NewLayer); }, EFoveInvoke::Monitor) != Fove::EFVR_ErrorCode::None)
+				continue;
+
+			FScopeLock Lock(&LayerLock);
+			OverlayLayers[Slots[Index]] = NewLayer;
+			bCreated = true;
+		}
+
+		if (bCreated)
+			FPlatformAtomics::InterlockedIncrement(&LayerRevision);
+	}
+
+	const TSharedRef<Fove::IFVRHeadset, ESPMode::ThreadSafe> Headset;
+	const TSharedRef<Fove::IFVRCompositor, ESPMode::ThreadSafe> Compositor;
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	volatile bool bStopping = false;
+
+	volatile int32 PackedState = 0; // See FFoveSystemState::Pack()
+	bool bInitiallyReady = false;   // Whether the headset was ready at the poll made on construction
+
+	mutable FCriticalSection LayerLock;
+	Fove::SFVR_CompositorLayer Layer;
+	TArray<Fove::SFVR_CompositorLayerCreateInfo> OverlayCreateInfos; // Settings for each overlay layer, indexed by slot
+	TArray<Fove::SFVR_CompositorLayer> OverlayLayers;                // The overlay layers themselves, indexed by slot
+	volatile int32 LayerRevision = 0;                                // Bumped whenever any of the layers above changes
+};
+
 #ifdef _MSC_VER
 #pragma endregion
 #endif
@@ -439,104 +2739,251 @@ public: // IHeadMountedDisplayModule implementation
 	{
 		IFoveHMDPlugin::StartupModule();
 
+		// Commandlets never use the headset, so nothing is discovered there
+		// Creating the headset and compositor objects in commandlets causes a "SECURE CRT: Invalid parameter detected" error when packing
+		// projects with the FOVE plugin (the reason for this is unknown)
+		if (IsRunningCommandlet())
+			return;
+
 		// On windows, we delay loading of the DLL, so the game can function if it's missing
 		// This is not implemented on other platforms currently
+		FString LibraryPath;
 #if PLATFORM_WINDOWS
 		if (!dllHandle)
 		{
 			// Get the library path based on the base dir of this plugin
 			const FString baseDir = IPluginManager::Get().FindPlugin("FoveHMD")->GetBaseDir();
 			const FString foveLibDir = FString::Printf(TEXT("Binaries/ThirdParty/FoveVR/FoveVR_SDK_%s/x64/FoveClient.dll"), FOVEVR_SDK_VER);
-			const FString libraryPath = FPaths::Combine(*baseDir, *foveLibDir);
-
-			// Load the fove client dll and show an error if it fails
-			dllHandle = !libraryPath.IsEmpty() ? FPlatformProcess::GetDllHandle(*libraryPath) : nullptr;
-			if (!dllHandle)
-			{
-				UE_LOG(LogHMD, Warning, TEXT("Failed to load FoveVR DLL handle"));
-				FMessageDialog::Open(EAppMsgType::Ok, FText::FromString("Failed to load FoveClient: " + libraryPath));
-				return;
-			}
+			LibraryPath = FPaths::Combine(*baseDir, *foveLibDir);
 		}
 #endif
 
-		// We do not create the Headset and Compositor objects here, hence the CreateObjectsIfNeeded() function
-		// If we do so, it causes a "SECURE CRT: Invalid parameter detected" error when packing projects with the FOVE plugin
-		// The reason for this is unknown
+		// Loading the client library, connecting to the FOVE service, creating the headset and compositor objects and creating the
+		// compositor layer can each take seconds when the service is slow to respond or not running, so all of that is done on its own thread
+		// The engine picks up the result through IsHMDConnected and CreateHeadMountedDisplay, which wait for it no longer than fove.DiscoveryTimeout
+		bDiscoveryEnabled = true;
+		DiscoveryDeadline = FPlatformTime::Seconds() + FMath::Max(CVarFoveDiscoveryTimeout.GetValueOnGameThread(), 0.0f);
+		StartDiscovery(LibraryPath, EAsyncExecution::Thread);
+		DiscoveryTickHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FFoveHMDPlugin::TickDiscovery), 0.1f);
 	}
 
 	void ShutdownModule() override
 	{
+		if (DiscoveryTickHandle.IsValid())
+		{
+			FTicker::GetCoreTicker().RemoveTicker(DiscoveryTickHandle);
+			DiscoveryTickHandle.Reset();
+		}
+
+		// The discovery thread may still be talking to the service, and must be done before the DLL is unloaded
+		// Its result is only taken so that it's released below, and any error it hit is left unreported
+		if (Discovery.IsValid())
+		{
+			Discovery.Wait();
+			AdoptDiscovery();
+		}
+
 		// Clear headset & compositor
 		// It is assumed that all other references are cleared by now as well
 		Headset.Reset();
 		Compositor.Reset();
 
-		// Unload the fove client dll
-		if (dllHandle)
+		// Unload the fove client dll
+		if (dllHandle)
+		{
+			FPlatformProcess::FreeDllHandle(dllHandle);
+			dllHandle = nullptr;
+		}
+
+		// Call base class last per standard ordering
+		IFoveHMDPlugin::ShutdownModule();
+	}
+
+
+#if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 18
+	TSharedPtr<class IXRTrackingSystem  , ESPMode::ThreadSafe> CreateTrackingSystem() override
+#else
+	TSharedPtr<class IHeadMountedDisplay, ESPMode::ThreadSafe> CreateHeadMountedDisplay() override
+#endif
+	{
+		// Everything the HMD needs was created by discovery, so this makes no calls into the FOVE service itself
+		if (!IsDiscoveryComplete() || !Headset.IsValid() || !Compositor.IsValid() || Layer.layerId == 0)
+			return nullptr;
+
+		TSharedPtr<FFoveHMD, ESPMode::ThreadSafe> FoveHMD(new FFoveHMD(Headset.ToSharedRef(), MoveTemp(Compositor), Layer));
+
+		// Compositor should be moved into the FFoveHMD class, but clear it just in cas
+		// This ensures that, if we create antoher FFoveHMD, it will get it's own compositor with it's own layer
+		// The old FFoveHMD will destroy it's own compositor (and layer) when it dies
+		// Currently there is no destroy layer functionality so we must destroy the IFVRCompositor object itself
+		Compositor = TUniquePtr<Fove::IFVRCompositor>();
+		Layer = Fove::SFVR_CompositorLayer();
+
+		return FoveHMD;
+	}
+
+#if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 14
+	FString GetModuleKeyName() const override
+#else
+	FString GetModulePriorityKeyName() const override
+#endif
+	{
+		return FString(TEXT("FoveHMD"));
+	}
+	
+	bool IsHMDConnected() override
+	{
+		check(IsInGameThread());
+
+		// Once the HMD exists its health monitor does the polling, so this is a single atomic load
+		if (FFoveHMD* const Hmd = FFoveHMD::Get())
+			return Hmd->IsHMDConnected();
+
+		// Otherwise rediscover from the thread pool at the health monitor's rate, and report the result of the last discovery
+		// This is called every frame by parts of the editor, so it must not talk to the FOVE service itself
+		PollConnectionIfDue();
+		return bConnected;
+	}
+
+private:
+
+	// A background discovery, see StartDiscovery
+	struct FDiscovery
+	{
+		void* DllHandle = nullptr;
+		FString FailedLibraryPath; // Set if the client library could not be loaded
+		TSharedPtr<Fove::IFVRHeadset, ESPMode::ThreadSafe> Headset;
+		TUniquePtr<Fove::IFVRCompositor> Compositor;
+		Fove::SFVR_CompositorLayer Layer; // Layer for the HMD to render into, only created once the headset is connected
+		bool bConnected = false;          // Whether the headset was connected and the compositor ready when discovery finished
+	};
+
+	// Starts a background discovery, which is handed the objects created by the previous one so it only creates what is missing
+	// The library is only loaded if a path is given. Nothing here touches the objects again until the discovery has been adopted
+	void StartDiscovery(const FString& LibraryPath, const EAsyncExecution Execution)
+	{
+		check(IsInGameThread());
+		check(!Discovery.IsValid());
+
+		const TSharedPtr<FDiscovery, ESPMode::ThreadSafe> Job = MakeShareable(new FDiscovery);
+		Job->Headset = MoveTemp(Headset);
+		Job->Compositor = MoveTemp(Compositor);
+		Job->Layer = Layer;
+		Layer = Fove::SFVR_CompositorLayer();
+
+		Discovery = Async<TSharedPtr<FDiscovery, ESPMode::ThreadSafe>>(Execution, [LibraryPath, Job]()
+		{
+			Discover(LibraryPath, *Job);
+			return Job;
+		});
+	}
+
+	// Runs on the discovery thread
+	static void Discover(const FString& LibraryPath, FDiscovery& Result)
+	{
+		// Load the fove client dll, the error is shown from the core ticker once discovery completes
+		if (!LibraryPath.IsEmpty())
+		{
+			Result.DllHandle = FPlatformProcess::GetDllHandle(*LibraryPath);
+			if (!Result.DllHandle)
+			{
+				Result.FailedLibraryPath = LibraryPath;
+				return;
+			}
+		}
+
+		CreateObjects(Result.Headset, Result.Compositor);
+		Result.bConnected = Result.Headset.IsValid() && Result.Compositor.IsValid() && IsFoveConnected(*Result.Headset, *Result.Compositor);
+
+		// Create the layer for the HMD here as well, so that creating the HMD on the game thread never waits on the service
+		if (Result.bConnected && Result.Layer.layerId == 0)
+			FoveInvoke(EFoveApi::CreateLayer, [&] { return Result.Compositor->CreateLayer(GetLayerCreateInfo(), &Result.Layer); });
+	}
+
+	// Takes ownership of the objects created by a finished discovery
+	void AdoptDiscovery()
+	{
+		check(IsInGameThread());
+
+		const TSharedPtr<FDiscovery, ESPMode::ThreadSafe> Result = Discovery.Get();
+		Discovery = TFuture<TSharedPtr<FDiscovery, ESPMode::ThreadSafe>>();
+		LastConnectionPollTime = FPlatformTime::Seconds();
+		if (!Result.IsValid())
+			return;
+
+		if (Result->DllHandle)
+			dllHandle = Result->DllHandle;
+		Headset = Result->Headset;
+		Compositor = MoveTemp(Result->Compositor);
+		Layer = Result->Layer;
+		bConnected = Result->bConnected;
+
+		if (!Result->FailedLibraryPath.IsEmpty())
+		{
+			UE_LOG(LogHMD, Warning, TEXT("Failed to load FoveVR DLL handle"));
+			FailedLibraryPath = Result->FailedLibraryPath;
+		}
+	}
+
+	// Takes the result of the running discovery if it has finished, and returns whether there is no discovery running
+	// While the engine is still starting up (which is when it picks its HMD), this first waits for it up to fove.DiscoveryTimeout after
+	// the plugin was loaded. The discovery overlaps with the rest of startup, so this usually doesn't wait at all
+	bool IsDiscoveryComplete()
+	{
+		check(IsInGameThread());
+
+		if (Discovery.IsValid() && !Discovery.IsReady() && !GIsRunning)
 		{
-			FPlatformProcess::FreeDllHandle(dllHandle);
-			dllHandle = nullptr;
+			const double Remaining = DiscoveryDeadline - FPlatformTime::Seconds();
+			if (Remaining > 0.0)
+				Discovery.WaitFor(FTimespan::FromSeconds(Remaining));
 		}
 
-		// Call base class last per standard ordering
-		IFoveHMDPlugin::ShutdownModule();
+		if (Discovery.IsValid() && Discovery.IsReady())
+			AdoptDiscovery();
+		return !Discovery.IsValid();
 	}
 
-
-#if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 18
-	TSharedPtr<class IXRTrackingSystem  , ESPMode::ThreadSafe> CreateTrackingSystem() override
-#else
-	TSharedPtr<class IHeadMountedDisplay, ESPMode::ThreadSafe> CreateHeadMountedDisplay() override
-#endif
+	// Polls the first discovery from the core ticker, and reports a failure to load the client library once it finishes
+	// The core ticker isn't ticked during shutdown, so no dialog is ever shown from there
+	bool TickDiscovery(const float DeltaTime)
 	{
-		CreateObjectsIfNeeded();
-		if (!Headset.IsValid() || !Compositor.IsValid())
-			return nullptr;
-
-		// Create a compositor layer
-		Fove::SFVR_CompositorLayer Layer;
-		Fove::SFVR_CompositorLayerCreateInfo LayerCreateInfo;
-		LayerCreateInfo.disableTimeWarp = FoveMode == FoveUnrealPluginMode::FixedToHMDScreen;
-		Compositor->CreateLayer(LayerCreateInfo, &Layer);
-
-		TSharedPtr<FFoveHMD, ESPMode::ThreadSafe> FoveHMD(new FFoveHMD(Headset.ToSharedRef(), MoveTemp(Compositor), Layer));
+		if (!IsDiscoveryComplete())
+			return true;
+		DiscoveryTickHandle.Reset();
 
-		// Compositor should be moved into the FFoveHMD class, but clear it just in cas
-		// This ensures that, if we create antoher FFoveHMD, it will get it's own compositor with it's own layer
-		// The old FFoveHMD will destroy it's own compositor (and layer) when it dies
-		// Currently there is no destroy layer functionality so we must destroy the IFVRCompositor object itself
-		Compositor = TUniquePtr<Fove::IFVRCompositor>();
+		if (!FailedLibraryPath.IsEmpty())
+			FMessageDialog::Open(EAppMsgType::Ok, FText::FromString("Failed to load FoveClient: " + FailedLibraryPath));
+		else if (bConnected && !FFoveHMD::Get())
+			UE_LOG(LogHMD, Log, TEXT("FOVE headset found after the engine picked its HMD. Raise fove.DiscoveryTimeout if it should be used at startup"));
 
-		return FoveHMD;
+		return false;
 	}
 
-#if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 14
-	FString GetModuleKeyName() const override
-#else
-	FString GetModulePriorityKeyName() const override
-#endif
-	{
-		return FString(TEXT("FoveHMD"));
-	}
-	
-	bool IsHMDConnected() override
+	// Starts a background rediscovery if the last one has finished and fove.HealthPollInterval has passed since it finished
+	void PollConnectionIfDue()
 	{
 		check(IsInGameThread());
 
-		CreateObjectsIfNeeded();
-		return Headset.IsValid() && Compositor.IsValid() && IsFoveConnected(*Headset, *Compositor);
-	}
+		// Nothing can be created if the client library failed to load
+		if (!bDiscoveryEnabled || !IsDiscoveryComplete() || !FailedLibraryPath.IsEmpty())
+			return;
 
-private:
+		if (FPlatformTime::Seconds() - LastConnectionPollTime < FMath::Max(CVarFoveHealthPollInterval.GetValueOnGameThread(), 0.05f))
+			return;
+
+		StartDiscovery(FString(), EAsyncExecution::ThreadPool);
+	}
 
-	void CreateObjectsIfNeeded()
+	// Creates the headset and compositor objects if they don't already exist
+	// This talks to the FOVE service, so it is only called on the discovery thread
+	static void CreateObjects(TSharedPtr<Fove::IFVRHeadset, ESPMode::ThreadSafe>& OutHeadset, TUniquePtr<Fove::IFVRCompositor>& OutCompositor)
 	{
-		if (!Headset.IsValid())
+		if (!OutHeadset.IsValid())
 		{
 			// Create the headset object
-			Headset = TSharedPtr<Fove::IFVRHeadset, ESPMode::ThreadSafe>(Fove::GetFVRHeadset());
-			if (!Headset.IsValid())
+			OutHeadset = TSharedPtr<Fove::IFVRHeadset, ESPMode::ThreadSafe>(Fove::GetFVRHeadset());
+			if (!OutHeadset.IsValid())
 			{
 				UE_LOG(LogHMD, Warning, TEXT("Failed to create IFVRHeadset"));
 				return;
@@ -550,15 +2997,15 @@ private:
 				Capabilities = Capabilities | Fove::EFVR_ClientCapabilities::Orientation;
 
 			// Initialize headset
-			Headset->Initialise(Capabilities);
+			FoveInvoke(EFoveApi::Initialise, [&] { return OutHeadset->Initialise(Capabilities); });
 		}
 
-		if (!Compositor.IsValid())
+		if (!OutCompositor.IsValid())
 		{
 			// Create or destroy the compositor object as needed
 			// To lower overhead and not open IPC to the compositor, we do this only once the headset is plugged in
-			Compositor = TUniquePtr<Fove::IFVRCompositor>(Fove::GetFVRCompositor());
-			if (!Compositor.IsValid())
+			OutCompositor = TUniquePtr<Fove::IFVRCompositor>(Fove::GetFVRCompositor());
+			if (!OutCompositor.IsValid())
 			{
 				UE_LOG(LogHMD, Warning, TEXT("Failed to create IFVRCompositor"));
 				return;
@@ -569,8 +3016,21 @@ private:
 	// Headset and compositor objects, these are shared with the FFoveHMD devices that we create
 	TSharedPtr<Fove::IFVRHeadset, ESPMode::ThreadSafe> Headset;
 	TUniquePtr<Fove::IFVRCompositor> Compositor;
+	Fove::SFVR_CompositorLayer Layer; // Layer created on Compositor for the next FFoveHMD, see Discover
 
 	void* dllHandle = nullptr;
+
+	// Background discovery, started in StartupModule and again by PollConnectionIfDue. This is invalid once its result has been adopted
+	// While one is running, the objects above are owned by it
+	TFuture<TSharedPtr<FDiscovery, ESPMode::ThreadSafe>> Discovery;
+	FDelegateHandle DiscoveryTickHandle;
+	double DiscoveryDeadline = 0.0;
+	bool bDiscoveryEnabled = false; // Never set in commandlets
+	FString FailedLibraryPath;
+
+	// Connection state reported by IsHMDConnected before the HMD has been created, see PollConnectionIfDue()
+	double LastConnectionPollTime = 0.0;
+	bool bConnected = false;
 };
 
 IMPLEMENT_MODULE(FFoveHMDPlugin, FoveHMD)
@@ -610,6 +3070,33 @@ FFoveHMD::FFoveHMD(TSharedRef<Fove::IFVRHeadset, ESPMode::ThreadSafe> headset, T
 	}
 #endif
 
+	PrivUpdateProjectionCache();
+
+	GazeSampler = MakeUnique<FFoveGazeSampler>(FoveHeadset);
+	HealthMonitor = MakeUnique<FFoveHealthMonitor>(FoveHeadset, FoveCompositor, FoveCompositorLayer);
+
+	// The loading layer watchdog lives as long as the HMD, and checks fove.LoadingLayer itself whenever rendering stalls
+	// It submits to an overlay layer of its own, which is time warped like the scene and covers it wherever the loading scene is opaque
+	if (Bridge)
+	{
+		Fove::SFVR_CompositorLayerCreateInfo LoadingLayerInfo;
+		LoadingLayerInfo.type = Fove::EFVR_ClientType::Overlay;
+		LoadingLayerInfo.alphaMode = Fove::EFVR_AlphaMode::Sample;
+		LoadingLayerId = PrivAddOverlayLayer(LoadingLayerInfo);
+
+		LoadingWatchdog = MakeUnique<FFoveLoadingWatchdog>(Bridge, FoveCompositor);
+		if (bProjectionCacheValid)
+			LoadingWatchdog->SetEyeFrusta(EyeProjections[0].Raw, EyeProjections[1].Raw);
+	}
+
+	// The HMD is created once discovery finishes, which can be after the startup level's components have registered
+	// Those components found no HMD to register with in OnRegister, so pick them up here instead
+	for (TObjectIterator<UFoveEyeTrackingComponent> It; It; ++It)
+	{
+		if (!It->IsTemplate() && It->IsRegistered())
+			RegisterEyeTrackingComponent(*It);
+	}
+
 	UE_LOG(LogHMD, Log, TEXT("FFoveHMD initialized"));
 }
 
@@ -617,13 +3104,22 @@ FFoveHMD::~FFoveHMD()
 {
 	UE_LOG(LogHMD, Log, TEXT("FFoveHMD destructing"));
 
+	// Stop the background threads before anything they use goes away
+	LoadingWatchdog.Reset();
+	GazeSampler.Reset();
+	HealthMonitor.Reset();
+
 	delete &Bridge;
 }
 
 FFoveHMD* FFoveHMD::Get()
 {
 	// Get the global HMD object
+	if (!GEngine)
+		return nullptr;
 #if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 18
+	if (!GEngine->XRSystem.IsValid())
+		return nullptr;
 	IHeadMountedDisplay* const Hmd = GEngine->XRSystem->GetHMDDevice();
 #else
 	IHeadMountedDisplay* const Hmd = GEngine->HMDDevice.Get();
@@ -647,133 +3143,80 @@ FFoveHMD* FFoveHMD::Get()
 bool FFoveHMD::IsHardwareConnected() const
 {
 	bool Ret = false;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->IsHardwareConnected(&Ret);
-	if (Error != Fove::EFVR_ErrorCode::None)
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::IsHardwareConnected: %d"), static_cast<int>(Error));
+	FoveInvoke(EFoveApi::IsHardwareConnected, [&] { return FoveHeadset->IsHardwareConnected(&Ret); });
 	return Ret;
 }
 
 bool FFoveHMD::IsHardwareReady() const
 {
 	bool Ret = false;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->IsHardwareReady(&Ret);
-	if (Error != Fove::EFVR_ErrorCode::None)
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::IsHardwareReady: %d"), static_cast<int>(Error));
+	FoveInvoke(EFoveApi::IsHardwareReady, [&] { return FoveHeadset->IsHardwareReady(&Ret); });
 	return Ret;
 }
 
+FFoveSystemState FFoveHMD::GetSystemState() const
+{
+	return HealthMonitor.IsValid() ? HealthMonitor->GetState() : FFoveSystemState();
+}
+
 bool FFoveHMD::IsEyeTrackingCalibrating() const
 {
 	bool Ret = false;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->IsEyeTrackingCalibrating(&Ret);
-	if (Error != Fove::EFVR_ErrorCode::None)
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::IsEyeTrackingCalibrating: %d"), static_cast<int>(Error));
+	FoveInvoke(EFoveApi::IsEyeTrackingCalibrating, [&] { return FoveHeadset->IsEyeTrackingCalibrating(&Ret); });
 	return Ret;
 }
 
 bool FFoveHMD::EnsureEyeTrackingCalibration()
 {
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->EnsureEyeTrackingCalibration();
-	if (Error != Fove::EFVR_ErrorCode::None)
-	{
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::EnsureEyeTrackingCalibration failed: %d"), static_cast<int>(Error));
-		return false;
-	}
-	return true;
+	return FoveInvoke(EFoveApi::EnsureEyeTrackingCalibration, [&] { return FoveHeadset->EnsureEyeTrackingCalibration(); }) == Fove::EFVR_ErrorCode::None;
 }
 
-bool FFoveHMD::GetGazeConvergence(const bool bRelativeToHMD, FVector* const outRayOrigin, FVector* const outRayDirection, float* const outDistance, float* const outAccuracy) const
+const FFoveGazeFrame& FFoveHMD::GetGazeFrame() const
 {
-	// Get latest pose. We always use the latest instead of the cached pose for maximum accuracy since the gaze data is the latest.
-	FQuat HMDOrientation;
-	if (bRelativeToHMD)
-	{
-		Fove::SFVR_Pose Pose;
-		const Fove::EFVR_ErrorCode Error = FoveHeadset->GetHMDPose(&Pose);
-		if (Error != Fove::EFVR_ErrorCode::None)
-		{
-			UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::GetHMDPose failed: %d"), static_cast<int>(Error));
-			return false;
-		}
+	check(IsInGameThread());
 
-		HMDOrientation = ToUnreal(Pose.orientation);
-	}
+	// Only go to the FOVE service for the first query of each frame
+	if (GazeFrame.FrameNumber != GFrameCounter)
+		PrivRefreshGazeFrame();
 
-	// Get gaze convergence
-	Fove::SFVR_GazeConvergenceData convergence;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->GetGazeConvergence(&convergence);
-	if (Error != Fove::EFVR_ErrorCode::None)
-	{
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::GetGazeConvergence failed: %d"), static_cast<int>(Error));
-		return false;
-	}
+	return GazeFrame;
+}
 
-	if (outRayOrigin)
-	{
-		*outRayOrigin = ToUnreal(convergence.ray.origin, WorldToMetersScale);
-		if (bRelativeToHMD)
-			*outRayOrigin = HMDOrientation.RotateVector(*outRayOrigin);
-	}
+bool FFoveHMD::GetLatestGazeSample(FFoveGazeSample& outSample) const
+{
+	return GazeSampler.IsValid() && GazeSampler->ReadLatest(outSample);
+}
 
-	if (outRayDirection)
-	{
-		*outRayDirection = ToUnreal(convergence.ray.direction, 1.0f);
-		if (bRelativeToHMD)
-			*outRayDirection = HMDOrientation.RotateVector(*outRayDirection);
-	}
+uint64 FFoveHMD::GetGazeSamplesSince(const uint64 SampleId, TArray<FFoveGazeSample>& outSamples) const
+{
+	return GazeSampler.IsValid() ? GazeSampler->ReadSince(SampleId, outSamples) : SampleId;
+}
 
-	if (outDistance)
-		*outDistance = WorldToMetersScale * convergence.distance;
+uint64 FFoveHMD::GetGazeEventsSince(const uint64 EventId, TArray<FFoveGazeEvent>& outEvents) const
+{
+	return GazeSampler.IsValid() ? GazeSampler->ReadEventsSince(EventId, outEvents) : EventId;
+}
 
-	if (outAccuracy)
-		*outAccuracy = convergence.accuracy;
+bool FFoveHMD::GetGazeConvergence(const bool bRelativeToHMD, FVector* const outRayOrigin, FVector* const outRayDirection, float* const outDistance, float* const outAccuracy) const
+{
+	return PrivGazeConvergence(GetGazeFrame().FilteredConvergence, bRelativeToHMD, outRayOrigin, outRayDirection, outDistance, outAccuracy);
+}
 
-	return true;
+bool FFoveHMD::GetRawGazeConvergence(const bool bRelativeToHMD, FVector* const outRayOrigin, FVector* const outRayDirection, float* const outDistance, float* const outAccuracy) const
+{
+	return PrivGazeConvergence(GetGazeFrame().Convergence, bRelativeToHMD, outRayOrigin, outRayDirection, outDistance, outAccuracy);
 }
 
 bool FFoveHMD::GetGazeVector(const bool bRelativeToHMD, FVector* const outLeft, FVector* const outRight) const
 {
-	// Get latest pose. We always use the latest instead of the cached pose for maximum accuracy since the gaze data is the latest.
-	FQuat HMDOrientation;
-	if (bRelativeToHMD)
-	{
-		Fove::SFVR_Pose Pose;
-		const Fove::EFVR_ErrorCode Error = FoveHeadset->GetHMDPose(&Pose);
-		if (Error != Fove::EFVR_ErrorCode::None)
-		{
-			UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::GetHMDPose failed: %d"), static_cast<int>(Error));
-			return false;
-		}
-
-		HMDOrientation = ToUnreal(Pose.orientation);
-	}
-
-	// Get left and/or right gaze
-	Fove::SFVR_GazeVector lGaze, rGaze;
-	const Fove::EFVR_ErrorCode error = FoveHeadset->GetGazeVectors(outLeft ? &lGaze : nullptr, outRight ? &rGaze : nullptr);
-	if (error != Fove::EFVR_ErrorCode::None)
-	{
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::GetGazeVectors failed: %d"), static_cast<int>(error));
-		return false;
-	}
-
-	// Output left gaze
-	if (outLeft)
-	{
-		*outLeft = ToUnreal(lGaze.vector, 1.0f);
-		if (!bRelativeToHMD)
-			*outLeft = HMDOrientation.RotateVector(*outLeft);
-	}
-
-	// Output right gaze
-	if (outRight)
-	{
-		*outRight = ToUnreal(rGaze.vector, 1.0f);
-		if (!bRelativeToHMD)
-			*outRight = HMDOrientation.RotateVector(*outRight);
-	}
+	const FFoveGazeFrame& Frame = GetGazeFrame();
+	return PrivGazeVector(Frame.FilteredLeftGaze, Frame.FilteredRightGaze, bRelativeToHMD, outLeft, outRight);
+}
 
-	return true;
+bool FFoveHMD::GetRawGazeVector(const bool bRelativeToHMD, FVector* const outLeft, FVector* const outRight) const
+{
+	const FFoveGazeFrame& Frame = GetGazeFrame();
+	return PrivGazeVector(Frame.LeftGaze.vector, Frame.RightGaze.vector, bRelativeToHMD, outLeft, outRight);
 }
 
 bool FFoveHMD::GetGazeVector2D(FVector2D* const outLeft, FVector2D* const outRight) const
@@ -788,28 +3231,20 @@ bool FFoveHMD::GetGazeVector2D(FVector2D* const outLeft, FVector2D* const outRig
 		return true;
 	};
 
-	// Get left/right projection
-	Fove::SFVR_Matrix44 lProj, rProj;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->GetProjectionMatricesLH(0.01f, 1000.0f, outLeft ? &lProj : nullptr, outRight ? &rProj : nullptr);
-	if (Error != Fove::EFVR_ErrorCode::None)
-	{
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::GetProjectionMatricesLH failed:  %d"), static_cast<int>(Error));
-		return false;
-	}
-
 	// Get left and/or right gaze
-	Fove::SFVR_GazeVector lGaze, rGaze;
-	const Fove::EFVR_ErrorCode error = FoveHeadset->GetGazeVectors(outLeft ? &lGaze : nullptr, outRight ? &rGaze : nullptr);
-	if (error != Fove::EFVR_ErrorCode::None)
-	{
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::GetGazeVectors failed: %d"), static_cast<int>(error));
+	const FFoveGazeFrame& Frame = GetGazeFrame();
+	if (!Frame.bGazeValid || !bProjectionCacheValid)
 		return false;
-	}
+
+	// Get left/right projection from the cache
+	// Only the X, Y and W rows are used, and those do not depend on the clip planes
+	const Fove::SFVR_Matrix44& lProj = EyeProjections[0].FoveMatrix;
+	const Fove::SFVR_Matrix44& rProj = EyeProjections[1].FoveMatrix;
 
 	FVector2D retLeft, retRight;
-	if (outLeft && !Compute2DGaze(lProj, lGaze.vector, retLeft))
+	if (outLeft && !Compute2DGaze(lProj, Frame.FilteredLeftGaze, retLeft))
 		return false;
-	if (outRight && !Compute2DGaze(rProj, rGaze.vector, retRight))
+	if (outRight && !Compute2DGaze(rProj, Frame.FilteredRightGaze, retRight))
 		return false;
 
 	if (outLeft)
@@ -823,20 +3258,16 @@ bool FFoveHMD::GetGazeVector2D(FVector2D* const outLeft, FVector2D* const outRig
 bool FFoveHMD::ManualDriftCorrection3D(const FVector Location)
 {
 	const Fove::SFVR_Vec3 vec(Location.Y / WorldToMetersScale, Location.Z / WorldToMetersScale, Location.X / WorldToMetersScale);
-	const Fove::EFVR_ErrorCode error = FoveHeadset->ManualDriftCorrection3D(vec);
-	return error == Fove::EFVR_ErrorCode::None;
+	return FoveInvoke(EFoveApi::ManualDriftCorrection3D, [&] { return FoveHeadset->ManualDriftCorrection3D(vec); }) == Fove::EFVR_ErrorCode::None;
 }
 
 bool FFoveHMD::CheckEyesTracked(bool* outLeft, bool* outRight)
 {
-	Fove::EFVR_Eye eye = Fove::EFVR_Eye::Neither;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->CheckEyesTracked(&eye);
-	if (Error != Fove::EFVR_ErrorCode::None)
-	{
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::CheckEyesTracked failed: %d"), static_cast<int>(Error));
+	const FFoveGazeFrame& Frame = GetGazeFrame();
+	if (!Frame.bEyesTrackedValid)
 		return false;
-	}
 
+	const Fove::EFVR_Eye eye = Frame.EyesTracked;
 	if (outLeft && (eye == Fove::EFVR_Eye::Both || eye == Fove::EFVR_Eye::Left))
 		*outLeft = true;
 
@@ -848,14 +3279,11 @@ bool FFoveHMD::CheckEyesTracked(bool* outLeft, bool* outRight)
 
 bool FFoveHMD::CheckEyesClosed(bool* outLeft, bool* outRight)
 {
-	Fove::EFVR_Eye eye = Fove::EFVR_Eye::Neither;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->CheckEyesClosed(&eye);
-	if (Error != Fove::EFVR_ErrorCode::None)
-	{
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::CheckEyesClosed failed: %d"), static_cast<int>(Error));
+	const FFoveGazeFrame& Frame = GetGazeFrame();
+	if (!Frame.bEyesClosedValid)
 		return false;
-	}
 
+	const Fove::EFVR_Eye eye = Frame.EyesClosed;
 	if (outLeft && (eye == Fove::EFVR_Eye::Both || eye == Fove::EFVR_Eye::Left))
 		*outLeft = true;
 
@@ -865,13 +3293,154 @@ bool FFoveHMD::CheckEyesClosed(bool* outLeft, bool* outRight)
 	return true;
 }
 
+bool FFoveHMD::GetEyeRelativeTransform(const bool bRightEye, const bool bFiltered, FTransform& outTransform) const
+{
+	const FFoveGazeFrame& Frame = GetGazeFrame();
+	if (!Frame.bGazeValid)
+		return false;
+
+	// The gaze vector of an untracked or closed eye is meaningless
+	const Fove::EFVR_Eye ThisEye = bRightEye ? Fove::EFVR_Eye::Right : Fove::EFVR_Eye::Left;
+	if (Frame.bEyesTrackedValid && Frame.EyesTracked != ThisEye && Frame.EyesTracked != Fove::EFVR_Eye::Both)
+		return false;
+	if (Frame.bEyesClosedValid && (Frame.EyesClosed == ThisEye || Frame.EyesClosed == Fove::EFVR_Eye::Both))
+		return false;
+
+	const Fove::SFVR_Vec3& Gaze = bRightEye
+		? (bFiltered ? Frame.FilteredRightGaze : Frame.RightGaze.vector)
+		: (bFiltered ? Frame.FilteredLeftGaze : Frame.LeftGaze.vector);
+	outTransform = PrivEyeRelativeTransform(Gaze, PrivGetEyeGeometry().EyeOffsets[bRightEye ? 1 : 0] * WorldToMetersScale);
+	return true;
+}
+
+void FFoveHMD::RegisterEyeTrackingComponent(UFoveEyeTrackingComponent* const Component)
+{
+	check(IsInGameThread());
+	EyeTrackingComponents.AddUnique(Component);
+}
+
+void FFoveHMD::UnregisterEyeTrackingComponent(UFoveEyeTrackingComponent* const Component)
+{
+	check(IsInGameThread());
+	EyeTrackingComponents.Remove(Component);
+}
+
+int32 FFoveHMD::CreateOverlayLayer(const bool bFixedToHMD)
+{
+	check(IsInGameThread());
+
+	Fove::SFVR_CompositorLayerCreateInfo CreateInfo;
+	CreateInfo.type = Fove::EFVR_ClientType::Overlay;
+	CreateInfo.alphaMode = Fove::EFVR_AlphaMode::Sample;
+	CreateInfo.disableTimeWarp = bFixedToHMD;
+	return PrivAddOverlayLayer(CreateInfo);
+}
+
+int32 FFoveHMD::PrivAddOverlayLayer(const Fove::SFVR_CompositorLayerCreateInfo& CreateInfo)
+{
+	check(IsInGameThread());
+
+	if (!HealthMonitor.IsValid())
+		return 0;
+
+	// The layer itself is created by the health monitor, and is picked up in PrivHandleReconnect once it exists
+	const int32 Slot = HealthMonitor->AddOverlayLayer(CreateInfo);
+	check(Slot == OverlayLayers.Num());
+
+	FOverlayLayer& Overlay = OverlayLayers[OverlayLayers.AddDefaulted()];
+	Overlay.Id = Slot + 1;
+	return Overlay.Id;
+}
+
+bool FFoveHMD::SetOverlayLayerTexture(const int32 OverlayId, UTextureRenderTarget2D* const RenderTarget, const FBox2D& LeftBounds, const FBox2D& RightBounds)
+{
+	check(IsInGameThread());
+
+	// The loading layer's overlay is submitted by the loading layer watchdog, so it can't be given a texture here
+	FOverlayLayer* const Overlay = OverlayLayers.FindByPredicate([OverlayId](const FOverlayLayer& Layer) { return Layer.Id == OverlayId; });
+	if (!Overlay || OverlayId == LoadingLayerId)
+		return false;
+
+	Overlay->RenderTarget = RenderTarget;
+	Overlay->Bounds[0] = LeftBounds;
+	Overlay->Bounds[1] = RightBounds;
+	return true;
+}
+
+void FFoveHMD::PrivUpdateOverlayLayers()
+{
+	check(IsInGameThread());
+
+	// The render target is only held weakly, so an overlay whose render target has been destroyed is dropped rather than submitted
+	// The resource is looked up again every frame, as resizing the render target replaces it
+	struct FPendingOverlay
+	{
+		int LayerId;
+		FTextureRenderTargetResource* Resource;
+		FBox2D Bounds[2];
+	};
+
+	TArray<FPendingOverlay> Pending;
+	for (FOverlayLayer& Overlay : OverlayLayers)
+	{
+		UTextureRenderTarget2D* const RenderTarget = Overlay.RenderTarget.Get();
+		if (!RenderTarget)
+		{
+			Overlay.RenderTarget.Reset();
+			continue;
+		}
+
+		// Skip layers that failed to be created again after a reconnect
+		FTextureRenderTargetResource* const Resource = RenderTarget->GameThread_GetRenderTargetResource();
+		if (Resource && Overlay.Layer.layerId != 0)
+			Pending.Add(FPendingOverlay{ Overlay.Layer.layerId, Resource, { Overlay.Bounds[0], Overlay.Bounds[1] } });
+	}
+
+	// Any release of the resources above is enqueued after this, so they are still alive when it runs
+	// The RHI texture is resolved on the render thread for every frame, so it always matches the one the render target was last drawn into
+	PrivEnqueueRenderCommand([Pending](FFoveHMD& Hmd)
+	{
+		if (!Hmd.Bridge)
+			return;
+
+		TArray<FoveRenderingBridge::FOverlay> Overlays;
+		for (const FPendingOverlay& Overlay : Pending)
+		{
+			FTexture2DRHIRef Texture = Overlay.Resource->GetRenderTargetTexture();
+			if (!Texture)
+				continue;
+
+			FoveRenderingBridge::FOverlay& Submit = Overlays[Overlays.AddDefaulted()];
+			Submit.LayerId = Overlay.LayerId;
+			Submit.Texture = Texture;
+			Submit.Bounds[0] = Overlay.Bounds[0];
+			Submit.Bounds[1] = Overlay.Bounds[1];
+		}
+		Hmd.Bridge->SetOverlays(Overlays);
+	});
+}
+
+float FFoveHMD::GetEyeRenderScale() const
+{
+	if (CVarFoveDynamicResolution.GetValueOnGameThread() == 0)
+		return 1.0f;
+
+	return DynamicResolution.Scale;
+}
+
+bool FFoveHMD::GetFoveationInset(const bool bRightEye, FBox2D& outInset) const
+{
+	if (!Foveation.bActive)
+		return false;
+
+	outInset = Foveation.GetInsetUVs(bRightEye ? 1 : 0);
+	return true;
+}
+
 bool FFoveHMD::IsPositionReady() const
 {
 	bool Ret = false;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->IsPositionReady(&Ret);
-	if (Error != Fove::EFVR_ErrorCode::None)
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::IsPositionReady failed: %d"), static_cast<int>(Error));
-
+	FoveInvoke(EFoveApi::IsPositionReady, [&] { return FoveHeadset->IsPositionReady(&Ret); });
 	return Ret;
 }
 
@@ -895,7 +3464,9 @@ bool FFoveHMD::EnumerateTrackedDevices(TArray<int, FDefaultAllocator>& OutDevice
 
 void FFoveHMD::RefreshPoses()
 {
-	// TODO
+	// The cached pose is only used on the game thread. The render thread takes its pose from the compositor instead
+	if (IsInGameThread())
+		PrivRefreshPose();
 }
 
 bool FFoveHMD::GetCurrentPose(const int32 deviceId, FQuat& OutQuat, FVector& OutVec)
@@ -916,9 +3487,28 @@ FName FFoveHMD::GetDeviceName() const
 }
 #endif
 
+bool FFoveHMD::OnStartGameFrame(FWorldContext& WorldContext)
+{
+	// 4.18+ calls RefreshPoses itself, but earlier versions have no such hook, so fetch the pose for the frame here
+#if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION < 18
+	PrivRefreshPose();
+#endif
+
+	// Fire blink and tracking events before anything ticks, so listeners see them this frame
+	PrivDispatchEyeStateEvents();
+
+	PrivHandleReconnect();
+
+	// Summarise any service errors that have stopped repeating, since the reporter otherwise only flushes when an error occurs
+	GFoveErrorReporter.FlushIfDue();
+
+	return FOVEHMD_BASE_CLASS::OnStartGameFrame(WorldContext);
+}
+
 bool FFoveHMD::IsHMDConnected()
 {
-	return IsFoveConnected(*FoveHeadset, *FoveCompositor);
+	// The health monitor does the polling, so this is a single atomic load
+	return GetSystemState().IsHMDConnected();
 }
 
 bool FFoveHMD::IsHMDEnabled() const
@@ -987,13 +3577,7 @@ void FFoveHMD::SetInterpupillaryDistance(float NewInterpupillaryDistance)
 
 float FFoveHMD::GetInterpupillaryDistance() const
 {
-	// Fetch inter-ocular distance from Fove service
-	float Ret = 0.064f; // Sane default in the event of error
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->GetIOD(&Ret);
-	if (Error != Fove::EFVR_ErrorCode::None)
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::GetIOD failed: %d"), static_cast<int>(Error));
-
-	return Ret;
+	return PrivGetEyeGeometry().IOD;
 }
 
 bool FFoveHMD::DoesSupportPositionalTracking() const
@@ -1007,9 +3591,7 @@ bool FFoveHMD::HasValidTrackingPosition()
 {
 	// Todo: FOVE API has no way to return whether we currently have a valid position, simply that position tracking is running
 	bool Ret = false;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->IsPositionReady(&Ret);
-	if (Error != Fove::EFVR_ErrorCode::None)
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::IsPositionReady: %d"), static_cast<int>(Error));
+	FoveInvoke(EFoveApi::IsPositionReady, [&] { return FoveHeadset->IsPositionReady(&Ret); });
 	return Ret;
 }
 
@@ -1038,12 +3620,12 @@ void FFoveHMD::ResetOrientationAndPosition(float yaw)
 void FFoveHMD::ResetOrientation(float yaw)
 {
 	// Fixme: what to do with yaw?
-	FoveHeadset->TareOrientationSensor();
+	FoveInvoke(EFoveApi::TareOrientationSensor, [&] { return FoveHeadset->TareOrientationSensor(); });
 }
 
 void FFoveHMD::ResetPosition()
 {
-	FoveHeadset->TarePositionSensors();
+	FoveInvoke(EFoveApi::TarePositionSensors, [&] { return FoveHeadset->TarePositionSensors(); });
 }
 
 void FFoveHMD::SetBaseRotation(const FRotator& BaseRot)
@@ -1253,8 +3835,12 @@ FMatrix FFoveHMD::GetStereoProjectionMatrix(const EStereoscopicPass StereoPass)
 
 void FFoveHMD::SetClippingPlanes(float NCP, float FCP)
 {
+	if (NCP == ZNear && FCP == ZFar)
+		return;
+
 	ZNear = NCP;
 	ZFar = FCP;
+	PrivUpdateProjectionCache();
 }
 
 void FFoveHMD::GetEyeRenderParams_RenderThread(const FRenderingCompositePassContext& Context, FVector2D& EyeToSrcUVScaleValue, FVector2D& EyeToSrcUVOffsetValue) const
@@ -1331,10 +3917,32 @@ bool FFoveHMD::EnableStereo(const bool enable)
 void FFoveHMD::AdjustViewRect(EStereoscopicPass StereoPass, int32& X, int32& Y, uint32& SizeX, uint32& SizeY) const
 {
 	SizeX = SizeX / 2;
-	if (StereoPass == eSSP_RIGHT_EYE)
+	if (StereoPass == eSSP_RIGHT_EYE || (IsFoveInsetPass(StereoPass) && GetFoveEyeIndex(StereoPass) == 1))
 	{
 		X += SizeX;
 	}
+
+	// When foveated, the full resolution inset goes into the bottom right of the eye's half, out of the way of the periphery
+	// PeripheryScale is kept below 1 - InsetSize, and the inset is rounded down where the periphery is rounded up, so the two never overlap
+	if (Foveation.bActive && IsFoveInsetPass(StereoPass))
+	{
+		const uint32 InsetX = FMath::Max(1, FMath::FloorToInt(SizeX * Foveation.InsetSize));
+		const uint32 InsetY = FMath::Max(1, FMath::FloorToInt(SizeY * Foveation.InsetSize));
+		X += SizeX - InsetX;
+		Y += SizeY - InsetY;
+		SizeX = InsetX;
+		SizeY = InsetY;
+		return;
+	}
+
+	// Render each eye into the top left of its half when running below full resolution
+	// The render target itself keeps its full size, and the compositor is told about the sub-rect in PreRenderViewFamily_RenderThread
+	const float Scale = Foveation.bActive ? Foveation.PeripheryScale : GetEyeRenderScale();
+	if (Scale < 1.0f)
+	{
+		SizeX = FMath::Max(1, FMath::CeilToInt(SizeX * Scale));
+		SizeY = FMath::Max(1, FMath::CeilToInt(SizeY * Scale));
+	}
 }
 
 void FFoveHMD::GetOrthoProjection(int32 RTWidth, int32 RTHeight, float OrthoDistance, FMatrix OrthoProjection[2]) const
@@ -1354,10 +3962,10 @@ void FFoveHMD::InitCanvasFromView(FSceneView* InView, UCanvas* Canvas)
 
 void FFoveHMD::CalculateStereoViewOffset(const EStereoscopicPass StereoPassType, const FRotator& ViewRotation, const float WorldToMeters, FVector& ViewLocation)
 {
-	if (StereoPassType == eSSP_LEFT_EYE || StereoPassType == eSSP_RIGHT_EYE)
+	if (StereoPassType == eSSP_LEFT_EYE || StereoPassType == eSSP_RIGHT_EYE || IsFoveInsetPass(StereoPassType))
 	{
-		const float EyeOffset = GetInterpupillaryDistance() * WorldToMeters / (StereoPassType == eSSP_LEFT_EYE ? -2.0f : 2.0f);
-		ViewLocation += ViewRotation.Quaternion().RotateVector(FVector(0, EyeOffset, 0));
+		const FVector& EyeOffset = PrivGetEyeGeometry().EyeOffsets[GetFoveEyeIndex(StereoPassType)];
+		ViewLocation += ViewRotation.Quaternion().RotateVector(EyeOffset * WorldToMeters);
 	}
 }
 
@@ -1370,42 +3978,112 @@ void FFoveHMD::RenderTexture_RenderThread(FRHICommandListImmediate& RHICmdList,
 {
 	check(IsInRenderingThread());
 
-	// Abort if we have not enabled mirroring
-	if (WindowMirrorMode == 0)
+	// Foveated frames are combined first, since that is what gets submitted whether or not the mirror is drawn
+	const FTexture2DRHIParamRef EyeTexture = PrivComposeFoveation_RenderThread(RHICmdList, SrcTexture);
+
+	SCOPE_CYCLE_COUNTER(STAT_FoveMirror);
+
+	// Skip drawing the mirror if it's disabled or this isn't one of the frames it's drawn on (see fove.MirrorInterval)
+	// The window isn't presented either in that case, so it keeps the last image without costing any more GPU time
+	const int32 MirrorMode = CVarFoveMirrorMode.GetValueOnRenderThread();
+	const uint32 MirrorInterval = static_cast<uint32>(FMath::Max(CVarFoveMirrorInterval.GetValueOnRenderThread(), 1));
+	const bool bMirrorThisFrame = MirrorMode != 0 && MirrorFrameCounter_RenderThread++ % MirrorInterval == 0;
+	if (Bridge)
+		Bridge->SetPresentWindow(bMirrorThisFrame);
+	if (!bMirrorThisFrame)
 	{
+		// Keep the intermediate texture between mirrored frames, unless mirroring is off altogether
+		if (MirrorMode == 0)
+			MirrorTexture_RenderThread.SafeRelease();
 		return;
 	}
 
-	const uint32 ViewportWidth = BackBuffer->GetSizeX();
-	const uint32 ViewportHeight = BackBuffer->GetSizeY();
+	const bool bSingleEye = MirrorMode == 1;
+	const FIntPoint BackBufferSize(BackBuffer->GetSizeX(), BackBuffer->GetSizeY());
 
-	// Set & clear the render target
+	// Reduced resolution mirrors are drawn into a smaller texture first, which is then stretched over the window
+	const float MirrorScale = FMath::Clamp(CVarFoveMirrorScale.GetValueOnRenderThread(), 0.25f, 1.0f);
+	const bool bDownsample = MirrorScale < 1.0f;
+	FIntPoint MirrorSize = BackBufferSize;
+	if (bDownsample)
+	{
+		MirrorSize = FIntPoint(FMath::Max(FMath::RoundToInt(BackBufferSize.X * MirrorScale), 2), FMath::Max(FMath::RoundToInt(BackBufferSize.Y * MirrorScale), 1));
+		if (!MirrorTexture_RenderThread || MirrorTexture_RenderThread->GetSizeXY() != MirrorSize || MirrorTexture_RenderThread->GetFormat() != BackBuffer->GetFormat())
+		{
+			FRHIResourceCreateInfo CreateInfo;
+			FTexture2DRHIRef ShaderResource;
+			RHICreateTargetableShaderResource2D(MirrorSize.X, MirrorSize.Y, BackBuffer->GetFormat(), 1, TexCreate_None, TexCreate_RenderTargetable, false, CreateInfo, MirrorTexture_RenderThread, ShaderResource);
+		}
+	}
+	else
+	{
+		MirrorTexture_RenderThread.SafeRelease();
+	}
+
+	// Draw one or both of the eye images, depending on the mirror mode
+	// The eyes may not fill their halves of the texture, so each eye is drawn from the region it was rendered into
+	// The combined texture of a foveated frame always has each eye filling its half
+	const FBox2D FullEyeBounds[2] = { FBox2D(FVector2D(0.0f, 0.0f), FVector2D(0.5f, 1.0f)), FBox2D(FVector2D(0.5f, 0.0f), FVector2D(1.0f, 1.0f)) };
+	const FBox2D* const EyeBounds = EyeTexture != SrcTexture ? FullEyeBounds : EyeUVBounds_RenderThread;
+	FBox2D SourceUVs[2];
+	FIntRect DestRects[2];
+	const int32 NumEyes = bSingleEye ? 1 : 2;
+	for (int32 EyeIndex = 0; EyeIndex < NumEyes; ++EyeIndex)
+	{
+		const FBox2D& Bounds = EyeBounds[EyeIndex];
+		const FVector2D BoundsSize = Bounds.GetSize();
+
+		// Single eye mode shows a crop of the center of the left eye, since the edges are mostly hidden by the lens anyway
+		SourceUVs[EyeIndex] = bSingleEye ? FBox2D(Bounds.Min + BoundsSize * 0.2f, Bounds.Min + BoundsSize * 0.8f) : Bounds;
+
+		const int32 X = bSingleEye ? MirrorSize.X / 4 : EyeIndex * (MirrorSize.X / 2);
+		DestRects[EyeIndex] = FIntRect(X, 0, X + MirrorSize.X / 2, MirrorSize.Y);
+	}
+
+	// Need to clear when rendering only one eye since the borders won't be touched by the eye rectangles
+	const FTexture2DRHIParamRef EyeTarget = bDownsample ? MirrorTexture_RenderThread.GetReference() : BackBuffer;
+	PrivDrawMirrorRects_RenderThread(RHICmdList, EyeTarget, bSingleEye, EyeTexture, SourceUVs, DestRects, NumEyes);
+
+	if (bDownsample)
 	{
-		// Need to clear when rendering only one eye since the borders won't be touched by the DrawRect below
-		const bool needsToClear = WindowMirrorMode == 1;
+		// The stretched texture covers the whole window, so there is nothing to clear
+		RHICmdList.CopyToResolveTarget(MirrorTexture_RenderThread, MirrorTexture_RenderThread, true, FResolveParams());
+		const FBox2D FullUV(FVector2D(0.0f, 0.0f), FVector2D(1.0f, 1.0f));
+		const FIntRect FullRect(0, 0, BackBufferSize.X, BackBufferSize.Y);
+		PrivDrawMirrorRects_RenderThread(RHICmdList, BackBuffer, false, MirrorTexture_RenderThread, &FullUV, &FullRect, 1);
+	}
+}
+
+void FFoveHMD::PrivDrawMirrorRects_RenderThread(FRHICommandListImmediate& RHICmdList, FTexture2DRHIParamRef Target, const bool bClear, FTexture2DRHIParamRef Source, const FBox2D* SourceUVs, const FIntRect* DestRects, const int32 NumRects) const
+{
+	check(IsInRenderingThread());
 
+	const FIntPoint TargetSize(Target->GetSizeX(), Target->GetSizeY());
+
+	// Set & clear the render target
+	{
 #if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 14
-		const ERenderTargetLoadAction loadAction = needsToClear ? ERenderTargetLoadAction::EClear : ERenderTargetLoadAction::ENoAction;
+		const ERenderTargetLoadAction loadAction = bClear ? ERenderTargetLoadAction::EClear : ERenderTargetLoadAction::ENoAction;
 #if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 16
-		FRHIRenderTargetView target(BackBuffer, loadAction);
+		FRHIRenderTargetView target(Target, loadAction);
 #else
-		FRHIRenderTargetView target(BackBuffer);
+		FRHIRenderTargetView target(Target);
 		target.LoadAction = loadAction;
 #endif
 		RHICmdList.SetRenderTargetsAndClear(FRHISetRenderTargetsInfo(1, &target, FRHIDepthRenderTargetView()));
 #else
-		SetRenderTarget(RHICmdList, BackBuffer, FTextureRHIRef());
+		SetRenderTarget(RHICmdList, Target, FTextureRHIRef());
 #endif
 
 		// Issue clear command on older versions that don't do it with the render target set
 #if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION < 14
-		if (needsToClear)
+		if (bClear)
 		{
 			RHICmdList.Clear(true, FLinearColor::Black, false, 0, false, 0, FIntRect());
 		}
 #endif
 
-		RHICmdList.SetViewport(0, 0, 0, ViewportWidth, ViewportHeight, 1.0f);
+		RHICmdList.SetViewport(0, 0, 0, TargetSize.X, TargetSize.Y, 1.0f);
 	}
 
 	// Get shaders
@@ -1416,16 +4094,34 @@ void FFoveHMD::RenderTexture_RenderThread(FRHICommandListImmediate& RHICmdList,
 
 	// Set render state
 #ifdef FOVE_USE_PIPLINE_STATE_CACHE
-	FGraphicsPipelineStateInitializer piplineState;
-	RHICmdList.ApplyCachedRenderTargets(piplineState);
-	piplineState.BlendState = TStaticBlendState<>::GetRHI();
-	piplineState.RasterizerState = TStaticRasterizerState<>::GetRHI();
-	piplineState.DepthStencilState = TStaticDepthStencilState<false, CF_Always>::GetRHI();
+	// The initializer is kept for each format of render target, and only filled in again if the shaders have changed (eg. after recompileshaders)
+	const FVertexShaderRHIParamRef VertexShaderRHI = GETSAFERHISHADER_VERTEX(*VertexShader);
+	const FPixelShaderRHIParamRef PixelShaderRHI = GETSAFERHISHADER_PIXEL(*PixelShader);
+	FMirrorPipelineState* Cached = MirrorPipelineStates_RenderThread.FindByPredicate([Target](const FMirrorPipelineState& State)
+	{
+		return State.Format == Target->GetFormat() && State.Flags == Target->GetFlags();
+	});
+	if (!Cached)
+	{
+		Cached = &MirrorPipelineStates_RenderThread[MirrorPipelineStates_RenderThread.AddDefaulted()];
+		Cached->Format = Target->GetFormat();
+		Cached->Flags = Target->GetFlags();
+	}
 
-	piplineState.BoundShaderState.VertexDeclarationRHI = RendererModule->GetFilterVertexDeclaration().VertexDeclarationRHI;
-	piplineState.BoundShaderState.VertexShaderRHI = GETSAFERHISHADER_VERTEX(*VertexShader);
-	piplineState.BoundShaderState.PixelShaderRHI = GETSAFERHISHADER_PIXEL(*PixelShader);
-	piplineState.PrimitiveType = PT_TriangleList;
+	FGraphicsPipelineStateInitializer& piplineState = Cached->Initializer;
+	if (piplineState.BoundShaderState.VertexShaderRHI != VertexShaderRHI || piplineState.BoundShaderState.PixelShaderRHI != PixelShaderRHI)
+	{
+		piplineState = FGraphicsPipelineStateInitializer();
+		RHICmdList.ApplyCachedRenderTargets(piplineState);
+		piplineState.BlendState = TStaticBlendState<>::GetRHI();
+		piplineState.RasterizerState = TStaticRasterizerState<>::GetRHI();
+		piplineState.DepthStencilState = TStaticDepthStencilState<false, CF_Always>::GetRHI();
+
+		piplineState.BoundShaderState.VertexDeclarationRHI = RendererModule->GetFilterVertexDeclaration().VertexDeclarationRHI;
+		piplineState.BoundShaderState.VertexShaderRHI = VertexShaderRHI;
+		piplineState.BoundShaderState.PixelShaderRHI = PixelShaderRHI;
+		piplineState.PrimitiveType = PT_TriangleList;
+	}
 
 	SetGraphicsPipelineState(RHICmdList, piplineState);
 #else
@@ -1438,29 +4134,84 @@ void FFoveHMD::RenderTexture_RenderThread(FRHICommandListImmediate& RHICmdList,
 #endif
 
 	// Set shader properties
-	PixelShader->SetParameters(RHICmdList, TStaticSamplerState<SF_Bilinear>::GetRHI(), SrcTexture);
-
-	// Draw a rectangle with the content of one or both of the eye images, depending on the mirror mode
-	RendererModule->DrawRectangle(
-		RHICmdList,
-		WindowMirrorMode == 1 ? ViewportWidth / 4 : 0,             // X
-		0,                                                         // Y
-		WindowMirrorMode == 1 ? ViewportWidth / 2 : ViewportWidth, // SizeX
-		ViewportHeight,                                            // SizeY
-		WindowMirrorMode == 1 ? 0.1f : 0.0f,                       // U
-		WindowMirrorMode == 1 ? 0.2f : 0.0f,                       // V
-		WindowMirrorMode == 1 ? 0.3f : 1.0f,                       // SizeU
-		WindowMirrorMode == 1 ? 0.6f : 1.0f,                       // SizeV
-		FIntPoint(ViewportWidth, ViewportHeight),
-		FIntPoint(1, 1),
-		*VertexShader,
-		EDRF_Default);
+	PixelShader->SetParameters(RHICmdList, TStaticSamplerState<SF_Bilinear>::GetRHI(), Source);
+
+	for (int32 i = 0; i < NumRects; ++i)
+	{
+		const FIntRect& Dest = DestRects[i];
+		const FVector2D SizeUV = SourceUVs[i].GetSize();
+		RendererModule->DrawRectangle(
+			RHICmdList,
+			Dest.Min.X,          // X
+			Dest.Min.Y,          // Y
+			Dest.Width(),        // SizeX
+			Dest.Height(),       // SizeY
+			SourceUVs[i].Min.X,  // U
+			SourceUVs[i].Min.Y,  // V
+			SizeUV.X,            // SizeU
+			SizeUV.Y,            // SizeV
+			TargetSize,
+			FIntPoint(1, 1),
+			*VertexShader,
+			EDRF_Default);
+	}
+}
+
+FTexture2DRHIParamRef FFoveHMD::PrivComposeFoveation_RenderThread(FRHICommandListImmediate& RHICmdList, FTexture2DRHIParamRef SrcTexture) const
+{
+	check(IsInRenderingThread());
+
+	// Unfoveated frames are submitted straight from the render target
+	if (!bFoveatedFrame_RenderThread || !Bridge)
+	{
+		FoveatedTexture_RenderThread.SafeRelease();
+		if (Bridge)
+			Bridge->SetSubmitTexture(FTexture2DRHIRef());
+		return SrcTexture;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FoveFoveation);
+
+	const FIntPoint Size(SrcTexture->GetSizeX(), SrcTexture->GetSizeY());
+	if (!FoveatedTexture_RenderThread || FoveatedTexture_RenderThread->GetSizeXY() != Size || FoveatedTexture_RenderThread->GetFormat() != SrcTexture->GetFormat())
+	{
+		FRHIResourceCreateInfo CreateInfo;
+		FTexture2DRHIRef ShaderResource;
+		RHICreateTargetableShaderResource2D(Size.X, Size.Y, SrcTexture->GetFormat(), 1, TexCreate_None, TexCreate_RenderTargetable, false, CreateInfo, FoveatedTexture_RenderThread, ShaderResource);
+	}
+
+	// Each periphery is stretched over the whole of its eye's half, and the inset is then drawn over it around the gaze point
+	// The inset covers as many pixels as it was rendered at, so it is copied across at full resolution
+	const int32 HalfX = Size.X / 2;
+	FBox2D SourceUVs[4];
+	FIntRect DestRects[4];
+	for (int32 EyeIndex = 0; EyeIndex < 2; ++EyeIndex)
+	{
+		const int32 X = EyeIndex * HalfX;
+		SourceUVs[EyeIndex] = EyeUVBounds_RenderThread[EyeIndex];
+		DestRects[EyeIndex] = FIntRect(X, 0, X + HalfX, Size.Y);
+
+		const FBox2D Inset = Foveation_RenderThread.GetInsetUVs(EyeIndex);
+		SourceUVs[2 + EyeIndex] = InsetUVBounds_RenderThread[EyeIndex];
+		DestRects[2 + EyeIndex] = FIntRect(
+			X + FMath::RoundToInt(Inset.Min.X * HalfX), FMath::RoundToInt(Inset.Min.Y * Size.Y),
+			X + FMath::RoundToInt(Inset.Max.X * HalfX), FMath::RoundToInt(Inset.Max.Y * Size.Y));
+	}
+
+	PrivDrawMirrorRects_RenderThread(RHICmdList, FoveatedTexture_RenderThread, false, SrcTexture, SourceUVs, DestRects, 4);
+	RHICmdList.CopyToResolveTarget(FoveatedTexture_RenderThread, FoveatedTexture_RenderThread, true, FResolveParams());
+
+	Bridge->SetSubmitTexture(FoveatedTexture_RenderThread);
+	return FoveatedTexture_RenderThread;
 }
 
 void FFoveHMD::CalculateRenderTargetSize(const FViewport& Viewport, uint32& InOutSizeX, uint32& InOutSizeY)
 {
 	check(IsInGameThread());
 
+	// This is the maximum size that will be rendered at
+	// Dynamic resolution renders into a sub-rect of this (see AdjustViewRect) so that it never causes a reallocation
+
 	//	if (Flags.bScreenPercentageEnabled)
 	{
 		static const auto CVar = IConsoleManager::Get().FindTConsoleVariableDataFloat(TEXT("r.ScreenPercentage"));
@@ -1516,17 +4267,70 @@ void FFoveHMD::UpdateViewport(bool bUseSeparateRenderTarget, const FViewport& In
 		else
 		{
 			viewportRef->SetCustomPresent(nullptr);
+			if (Bridge)
+			{
+				const TRefCountPtr<FoveRenderingBridge> BridgeRef = Bridge;
+				const TFunction<void()> StoppedCommand = [BridgeRef]()
+				{
+					BridgeRef->NotePresentStopped();
+				};
+
+				ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+					FoveNotePresentStopped,
+					TFunction<void()>, Command, StoppedCommand,
+					{
+						Command();
+					});
+			}
 		}
 	}
 }
 
 #endif
 
+#if FOVEHMD_SUPPORTS_FOVEATION
+
+int32 FFoveHMD::GetDesiredNumberOfViews(const bool bStereoRequested) const
+{
+	// The inset of each eye is an extra view, after the left and right eyes (see fove.Foveation)
+	const int32 NumViews = IStereoRendering::GetDesiredNumberOfViews(bStereoRequested);
+	return bStereoRequested && Foveation.bActive ? NumViews + 2 : NumViews;
+}
+
+EStereoscopicPass FFoveHMD::GetViewPassForIndex(const bool bStereoRequested, const uint32 ViewIndex) const
+{
+	if (bStereoRequested && Foveation.bActive && ViewIndex >= 2)
+		return ViewIndex == 2 ? eSSP_FOVE_LEFT_INSET : eSSP_FOVE_RIGHT_INSET;
+
+	return IStereoRendering::GetViewPassForIndex(bStereoRequested, ViewIndex);
+}
+
+uint32 FFoveHMD::GetViewIndexForPass(const EStereoscopicPass StereoPassType) const
+{
+	// Each inset keeps its own view index, so it gets its own view state (and with it, temporal AA history) from the local player
+	if (StereoPassType == eSSP_FOVE_LEFT_INSET)
+		return 2;
+	if (StereoPassType == eSSP_FOVE_RIGHT_INSET)
+		return 3;
+
+	return IStereoRendering::GetViewIndexForPass(StereoPassType);
+}
+
+#endif
+
 void FFoveHMD::SetupViewFamily(FSceneViewFamily& InViewFamily)
 {
+	// Retry fetching the projection if it failed previously or the headset was reconnected
+	// This runs before the stereo projection matrices are requested for the views in this family
+	if (!bProjectionCacheValid)
+		PrivUpdateProjectionCache();
+
 	InViewFamily.EngineShowFlags.MotionBlur = 0;
 	InViewFamily.EngineShowFlags.HMDDistortion = false;
 	InViewFamily.EngineShowFlags.StereoRendering = IsStereoEnabled();
+
+	// Decide on foveation and place the insets before the views are created, since they ask for their rects and projections
+	PrivUpdateFoveation();
 }
 
 void FFoveHMD::SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView)
@@ -1543,84 +4347,653 @@ void FFoveHMD::PreRenderView_RenderThread(FRHICommandListImmediate& RHICmdList,
 	// Update the view rotation with the latest value, sampled just beforehand in PreRenderViewFamily_RenderThread
 	if (Bridge)
 	{
-		const FQuat DeltaOrient = InView.BaseHmdOrientation.Inverse() * Bridge->GetRenderPose().GetRotation();
+		const FQuat DeltaOrient = InView.BaseHmdOrientation.Inverse() * Bridge->GetRenderPose_RenderThread().GetRotation();
 		InView.ViewRotation = FRotator(InView.ViewRotation.Quaternion() * DeltaOrient);
 		InView.UpdateViewMatrix();
 	}
 }
 
+void FFoveHMD::BeginRenderViewFamily(FSceneViewFamily& InViewFamily)
+{
+	check(IsInGameThread());
+
+	// Gather the primitives attached to each eye tracking component, along with the transforms they are about to be rendered with
+	TArray<FEyeTrackingLateUpdate> LateUpdates;
+	EyeTrackingComponents.RemoveAll([](const TWeakObjectPtr<UFoveEyeTrackingComponent>& Component) { return !Component.IsValid(); });
+	for (const TWeakObjectPtr<UFoveEyeTrackingComponent>& Component : EyeTrackingComponents)
+	{
+		if (!Component->bLateUpdate || !Component->bIsTracked)
+			continue;
+
+		if (LateUpdates.Num() == 0)
+			LateUpdates.Reserve(EyeTrackingComponents.Num());
+
+		FEyeTrackingLateUpdate& LateUpdate = LateUpdates[LateUpdates.AddDefaulted()];
+		LateUpdate.bRightEye = Component->Eye == EFoveEye::Right;
+		LateUpdate.bFiltered = Component->bUseFilteredGaze;
+		LateUpdate.EyeOffset = PrivGetEyeGeometry().EyeOffsets[LateUpdate.bRightEye ? 1 : 0] * WorldToMetersScale;
+		LateUpdate.RelativeTransform = Component->GetRelativeTransform();
+		LateUpdate.ParentToWorld = LateUpdate.RelativeTransform.Inverse() * Component->GetComponentToWorld();
+		PrivGatherEyeTrackingPrimitives(Component.Get(), LateUpdate.Primitives);
+	}
+
+	// Hand the list over to the render thread, replacing the one from the previous frame
+	// The eye geometry goes along with it, so the render thread places the eyes the same way the views were set up
+	// The foveation settings go along too, so the insets are placed where they were rendered
+	const FEyeGeometry Geometry = PrivGetEyeGeometry();
+	const FFoveation FrameFoveation = Foveation;
+	PrivEnqueueRenderCommand([LateUpdates, Geometry, FrameFoveation](FFoveHMD& Hmd)
+	{
+		Hmd.EyeTrackingLateUpdates_RenderThread = LateUpdates;
+		Hmd.EyeGeometry_RenderThread = Geometry;
+		Hmd.Foveation_RenderThread = FrameFoveation;
+	});
+
+	// Overlay textures are handed over with every frame as well
+	if (OverlayLayers.Num() > 0)
+		PrivUpdateOverlayLayers();
+}
+
 void FFoveHMD::PreRenderViewFamily_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneViewFamily& ViewFamily)
 {
 	check(IsInRenderingThread());
 
+	// Work out which part of the render target each eye was rendered into, which is less than half of it when the eye render scale is below 1
+	// UnscaledViewRect is used since anything rendered below that size (eg. via r.ScreenPercentage) is upscaled to it by the renderer
+	// The foveation insets are picked up the same way, and the frame is only treated as foveated if both were rendered
+	const FIntPoint TargetSize = ViewFamily.RenderTarget->GetSizeXY();
+	if (TargetSize.X > 0 && TargetSize.Y > 0)
+	{
+		int32 NumInsets = 0;
+		bool bHasEyes = false;
+		for (const FSceneView* const View : ViewFamily.Views)
+		{
+			const bool bInset = IsFoveInsetPass(View->StereoPass);
+			if (View->StereoPass != eSSP_LEFT_EYE && View->StereoPass != eSSP_RIGHT_EYE && !bInset)
+				continue;
+
+			const FIntRect& Rect = View->UnscaledViewRect;
+			const int32 EyeIndex = GetFoveEyeIndex(View->StereoPass);
+			FBox2D& Bounds = bInset ? InsetUVBounds_RenderThread[EyeIndex] : EyeUVBounds_RenderThread[EyeIndex];
+			Bounds = FBox2D(
+				FVector2D(Rect.Min.X / static_cast<float>(TargetSize.X), Rect.Min.Y / static_cast<float>(TargetSize.Y)),
+				FVector2D(Rect.Max.X / static_cast<float>(TargetSize.X), Rect.Max.Y / static_cast<float>(TargetSize.Y)));
+
+			NumInsets += bInset ? 1 : 0;
+			bHasEyes = true;
+		}
+
+		// Families without stereo views (eg. scene captures) leave the state of the last stereo frame alone
+		if (bHasEyes)
+			bFoveatedFrame_RenderThread = NumInsets == 2 && Foveation_RenderThread.bActive;
+	}
+
 	if (Bridge)
 	{
+		Bridge->NoteRenderThreadActivity();
+
+		// Foveated frames are combined into a texture with each eye filling its half, see PrivComposeFoveation_RenderThread
+		const FBox2D FullEyeBounds[2] = { FBox2D(FVector2D(0.0f, 0.0f), FVector2D(0.5f, 1.0f)), FBox2D(FVector2D(0.5f, 0.0f), FVector2D(1.0f, 1.0f)) };
+		const FBox2D* const SubmitBounds = bFoveatedFrame_RenderThread ? FullEyeBounds : EyeUVBounds_RenderThread;
+		Bridge->SetEyeBounds(SubmitBounds[0], SubmitBounds[1]);
+		if (!bFoveatedFrame_RenderThread)
+			Bridge->SetSubmitTexture(FTexture2DRHIRef());
+
 		// Blocks until the next time we need to render, as determined by the compositor, and fetches a new pose to use during rendering
 		// This allows the compositor to cap rendering at exactly the frame rate needed, so we don't draw more frames than the compositor can use
 		// Vsync and any other frame rate limiting options within Unreal should be disabled when using with FOVE to ensure this works well
 		// This also lets us update the pose just before rendering, so time warp only needs to correct by a small amount
+		// In the deferred pacing mode the wait happens in Present instead, and here we only pick up the pose handed out by that wait
 		Fove::SFVR_Pose FovePose;
-		const Fove::EFVR_ErrorCode Error = GetCompositor().WaitForRenderPose(&FovePose);
-		if (Error != Fove::EFVR_ErrorCode::None)
+		double PoseTime = 0.0;
+		Fove::EFVR_ErrorCode Error = Fove::EFVR_ErrorCode::None;
+		const bool bWaitInPresent = CVarFovePacingMode.GetValueOnRenderThread() == 1;
+		Bridge->SetWaitInPresent(bWaitInPresent);
+		if (bWaitInPresent)
 		{
-			UE_LOG(LogHMD, Warning, TEXT("IFVRCompositor::WaitForRenderPose failed: %d"), static_cast<int>(Error));
+			Error = FoveInvoke(EFoveApi::GetLastRenderPose, [&] { return GetCompositor().GetLastRenderPose(&FovePose); });
+			PoseTime = Bridge->GetLastPresentWaitEndTime();
+			PrivUpdateDynamicResolution_RenderThread(Bridge->GetLastPresentWaitSeconds());
 		}
 		else
+		{
+			SCOPE_CYCLE_COUNTER(STAT_FoveWaitForRenderPose);
+			const double WaitStartTime = FPlatformTime::Seconds();
+			Error = FoveInvoke(EFoveApi::WaitForRenderPose, [&] { return GetCompositor().WaitForRenderPose(&FovePose); });
+			PoseTime = FPlatformTime::Seconds();
+			PrivUpdateDynamicResolution_RenderThread(PoseTime - WaitStartTime);
+		}
+
+		if (Error == Fove::EFVR_ErrorCode::None)
 		{
 			// We will be moving the view location just before rendering, so camera-attached objects need a late update to stay locked to the view
 			// The API was removed for this so apparently it no longer needs up happen in 4.18+?
 #if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION < 18
-			const FTransform LastPose = Bridge->GetRenderPose();
-			Bridge->SetRenderPose(FovePose, WorldToMetersScale);
-			const FTransform NewPose = Bridge->GetRenderPose();
+			const FTransform LastPose = Bridge->GetRenderPose_RenderThread();
+			Bridge->SetRenderPose(FovePose, PoseTime, WorldToMetersScale, PrivPredictionHorizon(false));
+			const FTransform NewPose = Bridge->GetRenderPose_RenderThread();
 
 			ApplyLateUpdate(ViewFamily.Scene, LastPose, NewPose);
 #endif
 		}
 	}
+
+	// Move anything attached to eye tracking components to the newest eye tracking sample
+	PrivLateUpdateEyeTrackingComponents_RenderThread(ViewFamily.Scene);
 }
 
 void FFoveHMD::PrivOrientationAndPosition(FQuat& OutOrientation, FVector& OutPosition)
 {
 	checkf(IsInGameThread(), TEXT("PrivOrientationAndPosition called from not game thread"));
 
-	FTransform transform;
-	if (Bridge)
+	// With a bridge, start from the pose the compositor handed out for the last rendered frame
+	// Otherwise (eg. in the editor or on non-D3D11 RHIs), start from the pose cached for this frame
+	// Either way, extrapolate it to when the frame being simulated is expected to be displayed
+	// The bridge has no pose until the first frame has been rendered, so the cached pose is used until then too
+	FoveRenderingBridge::FRenderPose RenderPose;
+	const bool bHasRenderPose = Bridge && Bridge->GetRenderPose(RenderPose) != 0;
+	const Fove::SFVR_Pose& Pose = bHasRenderPose ? RenderPose.RawPose : PrivGetCachedPose().FovePose;
+	const FTransform transform = ToUnreal(PredictPose(Pose, PrivPredictionHorizon(bHasRenderPose)), WorldToMetersScale);
+
+	OutOrientation = transform.GetRotation();
+	OutPosition = transform.GetLocation();
+}
+
+float FFoveHMD::PrivPredictionHorizon(const bool bFromLastRenderPose) const
+{
+	const float Setting = CVarFovePosePrediction.GetValueOnAnyThread();
+	if (Setting == 0.0f)
+		return 0.0f;
+
+	// Without a bridge there is no compositor pacing to measure, so fall back to the game frame time
+	// This is called from both the game and render threads, so the frame period is read from the copy the render thread publishes
+	const double FramePeriod = Bridge ? DynamicResolution.PublishedFramePeriodMicros / 1000000.0 : FApp::GetDeltaTime();
+	// When the wait is deferred to Present, the render pose is handed out a whole frame before the frame it is used for is submitted
+	const double FramesToDisplay = Bridge && CVarFovePacingMode.GetValueOnAnyThread() == 1 ? 2.0 : 1.0;
+	const double RenderLatency = Setting > 0.0f ? Setting / 1000.0 : FramePeriod * FramesToDisplay;
+
+	// The game thread starts from the render pose fetched for the previous frame, which is one more frame from display
+	const double Horizon = bFromLastRenderPose ? RenderLatency + FramePeriod : RenderLatency;
+
+	// Velocities are only good for short extrapolations, so never predict far enough for the error to be worse than the latency
+	return FMath::Clamp(static_cast<float>(Horizon), 0.0f, 0.1f);
+}
+
+void FFoveHMD::PrivRefreshPose() const
+{
+	check(IsInGameThread());
+
+	FCachedPose& Pose = CachedPose;
+	Pose.FrameNumber = GFrameCounter;
+	Pose.Timestamp = FPlatformTime::Seconds();
+
+	// On failure, keep the last good pose rather than snapping the camera to the origin
+	Pose.bValid = FoveInvoke(EFoveApi::GetHMDPose, [&] { return FoveHeadset->GetHMDPose(&Pose.FovePose); }) == Fove::EFVR_ErrorCode::None;
+	if (Pose.bValid)
+		Pose.Transform = ToUnreal(Pose.FovePose, WorldToMetersScale);
+}
+
+const FFoveHMD::FCachedPose& FFoveHMD::PrivGetCachedPose() const
+{
+	check(IsInGameThread());
+
+	// The pose is normally fetched at the start of the frame, but fetch it here if that hasn't happened yet
+	if (CachedPose.FrameNumber != GFrameCounter)
+		PrivRefreshPose();
+
+	return CachedPose;
+}
+
+FMatrix FFoveHMD::PrivStereoProjectionMatrix(const EStereoscopicPass StereoPass) const
+{
+	check(IsStereoEnabled());
+
+	const int32 EyeIndex = GetFoveEyeIndex(StereoPass);
+	FMatrix Matrix = EyeProjections[EyeIndex].Matrix;
+	if (!bProjectionCacheValid)
 	{
-		transform = Bridge->GetRenderPose();
+		// The cache couldn't be filled (or was invalidated by a reconnect and hasn't been refetched yet), so query the SDK directly
+		// If that fails too, the last good projection is used, or identity if there has never been one
+		Fove::SFVR_Matrix44 FoveMat;
+		const Fove::EFVR_ErrorCode Error = FoveInvoke(EFoveApi::GetProjectionMatricesLH, [&] { return FoveHeadset->GetProjectionMatricesLH(ZNear, ZFar, EyeIndex == 0 ? &FoveMat : nullptr, EyeIndex == 1 ? &FoveMat : nullptr); });
+		if (Error == Fove::EFVR_ErrorCode::None)
+			Matrix = ToUnrealProjection(FoveMat, ZNear, ZFar);
 	}
-	else
+
+	// The inset is rendered with the part of the eye's frustum around the gaze point
+	// Remapping X and Y in clip space gives a frustum covering InsetSize of the eye's image in each dimension, centered on the gaze point
+	if (IsFoveInsetPass(StereoPass))
 	{
-		Fove::SFVR_Pose Pose;
-		const Fove::EFVR_ErrorCode Error = FoveHeadset->GetHMDPose(&Pose);
-		if (Error != Fove::EFVR_ErrorCode::None)
-			UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::GetHMDPose failed: %d"), static_cast<int>(Error));
+		const FVector2D& Center = Foveation.InsetCenters[EyeIndex];
+		const float InvSize = 1.0f / Foveation.InsetSize;
+		for (int32 Row = 0; Row < 4; ++Row)
+		{
+			Matrix.M[Row][0] = (Matrix.M[Row][0] - Center.X * Matrix.M[Row][3]) * InvSize;
+			Matrix.M[Row][1] = (Matrix.M[Row][1] - Center.Y * Matrix.M[Row][3]) * InvSize;
+		}
+	}
+
+	return Matrix;
+}
+
+const FFoveHMD::FEyeGeometry& FFoveHMD::PrivGetEyeGeometry() const
+{
+	// The render thread gets the copy handed over for the view family it is rendering, see BeginRenderViewFamily
+	// Without a separate render thread both checks pass, and the game thread's cache is used
+	if (IsInRenderingThread() && !IsInGameThread())
+		return EyeGeometry_RenderThread;
+
+	// Only the game thread refreshes the cache, other threads get whatever was fetched last
+	const double Now = FPlatformTime::Seconds();
+	FEyeGeometry& Geometry = EyeGeometry;
+	if (!IsInGameThread() || (Geometry.RefreshTime > 0.0 && Now - Geometry.RefreshTime < CVarFoveEyeGeometryRefreshInterval.GetValueOnGameThread()))
+		return Geometry;
+	Geometry.RefreshTime = Now;
+
+	// On failure, keep the last good values (or the defaults) rather than collapsing the stereo views together
+	float IOD = 0.0f;
+	if (FoveInvoke(EFoveApi::GetIOD, [&] { return FoveHeadset->GetIOD(&IOD); }) == Fove::EFVR_ErrorCode::None && IOD > 0.0f)
+		Geometry.IOD = IOD;
+
+	// Each eye to head matrix places the eye relative to the HMD, which is more accurate than assuming it is half of the IOD to the side
+	Fove::SFVR_Matrix44 FoveMats[2];
+	if (FoveInvoke(EFoveApi::GetEyeToHeadMatrices, [&] { return FoveHeadset->GetEyeToHeadMatrices(&FoveMats[0], &FoveMats[1]); }) == Fove::EFVR_ErrorCode::None)
+	{
+		FVector EyeOffsets[2];
+		for (int32 EyeIndex = 0; EyeIndex < 2; ++EyeIndex)
+		{
+			const FVector FoveOffset = ToUnreal(FoveMats[EyeIndex]).GetOrigin();
+			EyeOffsets[EyeIndex] = ToUnreal(Fove::SFVR_Vec3(FoveOffset.X, FoveOffset.Y, FoveOffset.Z), 1.0f);
+		}
 
-		transform = ToUnreal(Pose, WorldToMetersScale);
+		// Ignore matrices that don't put the left eye to the left of the right eye, as some runtimes leave them as identity
+		if (EyeOffsets[0].Y < EyeOffsets[1].Y)
+		{
+			Geometry.EyeOffsets[0] = EyeOffsets[0];
+			Geometry.EyeOffsets[1] = EyeOffsets[1];
+			return Geometry;
+		}
 	}
 
-	OutOrientation = transform.GetRotation();
-	OutPosition = transform.GetLocation();
+	Geometry.EyeOffsets[0] = FVector(0.0f, -0.5f * Geometry.IOD, 0.0f);
+	Geometry.EyeOffsets[1] = FVector(0.0f, 0.5f * Geometry.IOD, 0.0f);
+	return Geometry;
 }
 
-FMatrix FFoveHMD::PrivStereoProjectionMatrix(const EStereoscopicPass StereoPass) const
+void FFoveHMD::PrivUpdateProjectionCache()
 {
-	check(IsStereoEnabled());
+	check(IsInGameThread());
 
-	// Query Fove SDK for projection matrix for this eye
-	Fove::SFVR_Matrix44 FoveMat;
-	const Fove::EFVR_ErrorCode Error = FoveHeadset->GetProjectionMatricesLH(ZNear, ZFar, StereoPass == eSSP_LEFT_EYE ? &FoveMat : nullptr, StereoPass != eSSP_LEFT_EYE ? &FoveMat : nullptr);
+	// Query Fove SDK for the projection matrices of both eyes
+	Fove::SFVR_Matrix44 FoveMats[2];
+	Fove::EFVR_ErrorCode Error = FoveInvoke(EFoveApi::GetProjectionMatricesLH, [&] { return FoveHeadset->GetProjectionMatricesLH(ZNear, ZFar, &FoveMats[0], &FoveMats[1]); });
 	if (Error != Fove::EFVR_ErrorCode::None)
-		UE_LOG(LogHMD, Warning, TEXT("IFVRHeadset::IsPositionReady: %d"), static_cast<int>(Error));
+	{
+		bProjectionCacheValid = false;
+		return;
+	}
 
-	// Convert to Unreal matrix and correct near/far clip (which use reversed-Z in Unreal)
-	FMatrix Ret = ToUnreal(FoveMat);
-	Ret.M[3][3] = 0.0f;
-	Ret.M[2][3] = 1.0f;
-	Ret.M[2][2] = ZNear == ZFar ? 0.0f : ZNear / (ZNear - ZFar);
-	Ret.M[3][2] = ZNear == ZFar ? ZNear : -ZFar * ZNear / (ZNear - ZFar);
+	// Query the raw frustum extents as well, which are independent of the clip planes
+	Fove::SFVR_ProjectionParams RawParams[2];
+	Error = FoveInvoke(EFoveApi::GetRawProjectionValues, [&] { return FoveHeadset->GetRawProjectionValues(&RawParams[0], &RawParams[1]); });
+	if (Error != Fove::EFVR_ErrorCode::None)
+	{
+		bProjectionCacheValid = false;
+		return;
+	}
 
-	return Ret;
+	for (int32 EyeIndex = 0; EyeIndex < 2; ++EyeIndex)
+	{
+		FEyeProjection& Eye = EyeProjections[EyeIndex];
+		Eye.Raw = RawParams[EyeIndex];
+		Eye.FoveMatrix = FoveMats[EyeIndex];
+
+		Eye.Matrix = ToUnrealProjection(Eye.FoveMatrix, ZNear, ZFar);
+	}
+
+	if (LoadingWatchdog)
+		LoadingWatchdog->SetEyeFrusta(RawParams[0], RawParams[1]);
+
+	bProjectionCacheValid = true;
+}
+
+void FFoveHMD::PrivUpdateFoveation()
+{
+	check(IsInGameThread());
+
+	// The inset views are added to the family by index, which instanced stereo and the monoscopic far field don't expect
+	// The views are also combined before being submitted, which needs the rendering bridge
+	static const auto InstancedStereoCVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("vr.InstancedStereo"));
+	static const auto MonoscopicFarFieldCVar = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("vr.MonoscopicFarField"));
+	Foveation.bActive = FOVEHMD_SUPPORTS_FOVEATION
+		&& Bridge.IsValid()
+		&& IsStereoEnabled()
+		&& CVarFoveFoveation.GetValueOnGameThread() != 0
+		&& !(InstancedStereoCVar && InstancedStereoCVar->GetValueOnGameThread() != 0)
+		&& !(MonoscopicFarFieldCVar && MonoscopicFarFieldCVar->GetValueOnGameThread() != 0);
+	if (!Foveation.bActive)
+		return;
+
+	Foveation.InsetSize = FMath::Clamp(CVarFoveFoveationInsetSize.GetValueOnGameThread(), 0.1f, 0.9f);
+	Foveation.PeripheryScale = FMath::Min(FMath::Clamp(CVarFoveFoveationPeripheryScale.GetValueOnGameThread(), 0.1f, 1.0f) * GetEyeRenderScale(), 1.0f - Foveation.InsetSize);
+
+	// Center each inset on that eye's gaze point, keeping it within the eye's image
+	// While there is no gaze (eg. before the eye tracker has started) the insets stay where they were
+	FVector2D Gaze[2];
+	const bool bHasGaze = GetGazeVector2D(&Gaze[0], &Gaze[1]);
+	const float Limit = 1.0f - Foveation.InsetSize;
+	for (int32 EyeIndex = 0; EyeIndex < 2; ++EyeIndex)
+	{
+		const FVector2D& Center = bHasGaze ? Gaze[EyeIndex] : Foveation.InsetCenters[EyeIndex];
+		Foveation.InsetCenters[EyeIndex] = FVector2D(FMath::Clamp(Center.X, -Limit, Limit), FMath::Clamp(Center.Y, -Limit, Limit));
+	}
+}
+
+bool FFoveHMD::PrivGazeConvergence(const Fove::SFVR_GazeConvergenceData& Convergence, const bool bRelativeToHMD, FVector* const outRayOrigin, FVector* const outRayDirection, float* const outDistance, float* const outAccuracy) const
+{
+	const FFoveGazeFrame& Frame = GetGazeFrame();
+	if (!Frame.bConvergenceValid || (bRelativeToHMD && !Frame.bPoseValid))
+		return false;
+
+	if (outRayOrigin)
+	{
+		*outRayOrigin = ToUnreal(Convergence.ray.origin, WorldToMetersScale);
+		if (bRelativeToHMD)
+			*outRayOrigin = Frame.HMDOrientation.RotateVector(*outRayOrigin);
+	}
+
+	if (outRayDirection)
+	{
+		*outRayDirection = ToUnreal(Convergence.ray.direction, 1.0f);
+		if (bRelativeToHMD)
+			*outRayDirection = Frame.HMDOrientation.RotateVector(*outRayDirection);
+	}
+
+	if (outDistance)
+		*outDistance = WorldToMetersScale * Convergence.distance;
+
+	if (outAccuracy)
+		*outAccuracy = Convergence.accuracy;
+
+	return true;
+}
+
+bool FFoveHMD::PrivGazeVector(const Fove::SFVR_Vec3& Left, const Fove::SFVR_Vec3& Right, const bool bRelativeToHMD, FVector* const outLeft, FVector* const outRight) const
+{
+	const FFoveGazeFrame& Frame = GetGazeFrame();
+	if (!Frame.bGazeValid || (bRelativeToHMD && !Frame.bPoseValid))
+		return false;
+
+	// Output left gaze
+	if (outLeft)
+	{
+		*outLeft = ToUnreal(Left, 1.0f);
+		if (bRelativeToHMD)
+			*outLeft = Frame.HMDOrientation.RotateVector(*outLeft);
+	}
+
+	// Output right gaze
+	if (outRight)
+	{
+		*outRight = ToUnreal(Right, 1.0f);
+		if (bRelativeToHMD)
+			*outRight = Frame.HMDOrientation.RotateVector(*outRight);
+	}
+
+	return true;
+}
+
+void FFoveHMD::PrivHandleReconnect()
+{
+	check(IsInGameThread());
+
+	if (!HealthMonitor.IsValid())
+		return;
+
+	// The health monitor creates all of the compositor layers on its own thread, and this only picks up what it has created
+	const FFoveSystemState State = GetSystemState();
+	if (State.ConnectionGeneration != ConnectionGeneration)
+	{
+		ConnectionGeneration = State.ConnectionGeneration;
+
+		// The headset may have been swapped while disconnected, so the lens projection and eye geometry need to be fetched again
+		bProjectionCacheValid = false;
+		EyeGeometry.RefreshTime = 0.0;
+	}
+
+	const int32 Revision = HealthMonitor->GetLayerRevision();
+	if (Revision == LayerRevision)
+		return;
+	LayerRevision = Revision;
+
+	// Overlay layers are lost along with the base layer, and have a layerId of 0 until they are created again
+	// The bridge is pointed at the new ones with the next frame, see PrivUpdateOverlayLayers
+	Fove::SFVR_CompositorLayer Layer;
+	TArray<Fove::SFVR_CompositorLayer> NewOverlayLayers;
+	HealthMonitor->GetLayers(Layer, NewOverlayLayers);
+	for (int32 Slot = 0; Slot < OverlayLayers.Num() && Slot < NewOverlayLayers.Num(); ++Slot)
+		OverlayLayers[Slot].Layer = NewOverlayLayers[Slot];
+	if (LoadingWatchdog && OverlayLayers.IsValidIndex(LoadingLayerId - 1))
+		LoadingWatchdog->SetLayer(OverlayLayers[LoadingLayerId - 1].Layer.layerId);
+
+	// Switch over to the layer that the health monitor created for the new connection, keeping the old one if it isn't usable
+	if (Layer.layerId == 0)
+		return;
+	FoveCompositorLayer = Layer;
+	PrivEnqueueRenderCommand([Layer](FFoveHMD& Hmd)
+	{
+		if (Hmd.Bridge)
+			Hmd.Bridge->SetCompositorLayer(Layer);
+	});
+}
+
+void FFoveHMD::PrivEnqueueRenderCommand(const TFunction<void(FFoveHMD&)>& Function)
+{
+	// Commands that touch the render thread state of FFoveHMD go through here
+	// The macro generated command type has no access to the private types of FFoveHMD, so the work is passed in as a function
+	// The command only holds a weak reference, so it is skipped rather than touching a destroyed HMD if it runs after shutdown
+	const TWeakPtr<FFoveHMD, ESPMode::ThreadSafe> WeakHmd = AsShared();
+	const TFunction<void()> HmdCommand = [WeakHmd, Function]()
+	{
+		const TSharedPtr<FFoveHMD, ESPMode::ThreadSafe> Hmd = WeakHmd.Pin();
+		if (Hmd.IsValid())
+			Function(*Hmd);
+	};
+
+	ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+		FoveHmdCommand,
+		TFunction<void()>, Command, HmdCommand,
+		{
+			Command();
+		});
+}
+
+void FFoveHMD::PrivDispatchEyeStateEvents()
+{
+	check(IsInGameThread());
+
+	if (!GazeSampler.IsValid())
+		return;
+
+	TArray<FFoveEyeStateEvent> Events;
+	LastEyeStateEventId = GazeSampler->ReadEyeStateEventsSince(LastEyeStateEventId, Events);
+	for (const FFoveEyeStateEvent& Event : Events)
+	{
+		EyeStateChangedDelegate.Broadcast(Event);
+
+		// Listeners may destroy components, so check each one is still alive as we go
+		for (int32 i = 0; i < EyeTrackingComponents.Num(); ++i)
+		{
+			UFoveEyeTrackingComponent* const Component = EyeTrackingComponents[i].Get();
+			if (Component && Component->Eye == Event.Eye)
+				Component->OnEyeStateChanged.Broadcast(Event.Change, Event.Duration);
+		}
+	}
+}
+
+void FFoveHMD::PrivLateUpdateEyeTrackingComponents_RenderThread(FSceneInterface* const Scene)
+{
+	check(IsInRenderingThread());
+
+	// The sampler thread has usually received a sample or two since the game thread took its snapshot
+	FFoveGazeSample Sample;
+	if (EyeTrackingLateUpdates_RenderThread.Num() == 0 || !Scene || !GetLatestGazeSample(Sample))
+		return;
+
+	for (const FEyeTrackingLateUpdate& LateUpdate : EyeTrackingLateUpdates_RenderThread)
+	{
+		// Leave the component where the game thread put it if the eye has closed since then
+		const Fove::EFVR_Eye ThisEye = LateUpdate.bRightEye ? Fove::EFVR_Eye::Right : Fove::EFVR_Eye::Left;
+		if (Sample.bEyesClosedValid && (Sample.EyesClosed == ThisEye || Sample.EyesClosed == Fove::EFVR_Eye::Both))
+			continue;
+
+		const Fove::SFVR_Vec3& Gaze = LateUpdate.bRightEye
+			? (LateUpdate.bFiltered ? Sample.FilteredRightGaze : Sample.RightGaze.vector)
+			: (LateUpdate.bFiltered ? Sample.FilteredLeftGaze : Sample.LeftGaze.vector);
+		FTransform NewRelativeTransform = PrivEyeRelativeTransform(Gaze, LateUpdate.EyeOffset);
+		NewRelativeTransform.SetScale3D(LateUpdate.RelativeTransform.GetScale3D());
+
+		const FTransform OldLocalToWorld = LateUpdate.RelativeTransform * LateUpdate.ParentToWorld;
+		const FTransform NewLocalToWorld = NewRelativeTransform * LateUpdate.ParentToWorld;
+		const FMatrix LateUpdateTransform = (OldLocalToWorld.Inverse() * NewLocalToWorld).ToMatrixWithScale();
+
+		for (const FEyeTrackingPrimitive& Primitive : LateUpdate.Primitives)
+		{
+			FPrimitiveSceneInfo* const SceneInfo = Scene->GetPrimitiveSceneInfo(*Primitive.IndexAddress);
+			if (SceneInfo && SceneInfo == Primitive.SceneInfo && SceneInfo->Proxy)
+				SceneInfo->Proxy->ApplyLateUpdateTransform(LateUpdateTransform);
+		}
+	}
+}
+
+FTransform FFoveHMD::PrivEyeRelativeTransform(const Fove::SFVR_Vec3& Gaze, const FVector& EyeOffset)
+{
+	// The eye sits at its offset from the HMD, and looks along the gaze vector
+	const FVector Direction = ToUnreal(Gaze, 1.0f).GetSafeNormal();
+	return FTransform(Direction.Rotation().Quaternion(), EyeOffset);
+}
+
+void FFoveHMD::PrivGatherEyeTrackingPrimitives(USceneComponent* const Component, TArray<FEyeTrackingPrimitive>& Primitives)
+{
+	const UPrimitiveComponent* const PrimitiveComponent = Cast<UPrimitiveComponent>(Component);
+	if (PrimitiveComponent && PrimitiveComponent->SceneProxy)
+	{
+		FPrimitiveSceneInfo* const SceneInfo = PrimitiveComponent->SceneProxy->GetPrimitiveSceneInfo();
+		if (SceneInfo)
+			Primitives.Add(FEyeTrackingPrimitive{ SceneInfo->GetIndexAddress(), SceneInfo });
+	}
+
+	for (USceneComponent* const Child : Component->GetAttachChildren())
+	{
+		if (Child)
+			PrivGatherEyeTrackingPrimitives(Child, Primitives);
+	}
+}
+
+void FFoveHMD::PrivUpdateDynamicResolution_RenderThread(const double WaitSeconds)
+{
+	check(IsInRenderingThread());
+
+	FDynamicResolution& State = DynamicResolution;
+	const double Now = FPlatformTime::Seconds();
+	const double Interval = State.LastWaitEndTime > 0.0 ? Now - State.LastWaitEndTime : 0.0;
+	State.LastWaitEndTime = Now;
+
+	// Ignore the first frame, and long stalls such as level loads, which say nothing about rendering cost
+	if (Interval <= 0.0 || Interval > 0.5)
+		return;
+
+	// Estimate the compositor frame period as the shortest interval between frames over a window of frames
+	// Frames can only be late, never early, so the shortest interval is the closest to the real period
+	State.WindowMinInterval = FMath::Min(State.WindowMinInterval, Interval);
+	if (++State.WindowFrames >= 90 || State.FramePeriod <= 0.0)
+	{
+		State.FramePeriod = State.WindowMinInterval;
+		State.WindowMinInterval = MAX_dbl;
+		State.WindowFrames = 0;
+		FPlatformAtomics::InterlockedExchange(&State.PublishedFramePeriodMicros, static_cast<int32>(State.FramePeriod * 1000000.0));
+	}
+
+	if (CVarFoveDynamicResolution.GetValueOnRenderThread() == 0)
+	{
+		State.Scale = 1.0f;
+		return;
+	}
+
+	const float BudgetMs = CVarFoveDynamicResolutionFrameBudget.GetValueOnRenderThread();
+	const double Budget = BudgetMs > 0.0f ? BudgetMs / 1000.0 : State.FramePeriod;
+	if (Budget <= 0.0)
+		return;
+
+	// GPU time is what the render scale controls, so that is what gets compared against the budget
+	const double GpuSeconds = FPlatformTime::ToSeconds(RHIGetGPUFrameCycles());
+	const float Target = FMath::Clamp(CVarFoveDynamicResolutionTargetUtilization.GetValueOnRenderThread(), 0.1f, 1.0f);
+	float Utilization = static_cast<float>(GpuSeconds / Budget);
+
+	// A missed compositor frame with no time spent waiting means we are already over budget
+	// If the GPU was the bottleneck, make sure that this results in a step down even if the GPU timer lags behind
+	const double RenderThreadSeconds = Interval - WaitSeconds;
+	if (Interval > Budget * 1.5 && WaitSeconds < 0.001 && GpuSeconds >= RenderThreadSeconds)
+		Utilization = FMath::Max(Utilization, static_cast<float>(Interval / Budget));
+
+	// Only react once utilization leaves a band around the target, so the scale doesn't oscillate from frame to frame
+	const float Hysteresis = 0.05f;
+	float Scale = State.Scale;
+	if (Utilization > Target + Hysteresis || Utilization < Target - Hysteresis)
+	{
+		// GPU cost is roughly proportional to pixel count, which is the square of the per-axis scale
+		const float Desired = Scale * FMath::Sqrt(Target / FMath::Max(Utilization, 0.01f));
+
+		// Step down quickly to get out of trouble, but step up slowly to avoid overshooting
+		Scale = FMath::Clamp(Desired, Scale - 0.05f, Scale + 0.02f);
+	}
+
+	const float MinScale = FMath::Clamp(CVarFoveDynamicResolutionMinScale.GetValueOnRenderThread(), 0.1f, 1.0f);
+	State.Scale = FMath::Clamp(Scale, MinScale, 1.0f);
+}
+
+void FFoveHMD::PrivRefreshGazeFrame() const
+{
+	check(IsInGameThread());
+
+	FFoveGazeFrame& Frame = GazeFrame;
+	const uint64 PreviousLeftId = Frame.LeftGaze.id;
+	const uint64 PreviousRightId = Frame.RightGaze.id;
+	Frame.FrameNumber = GFrameCounter;
+
+	// Take the HMD orientation from the pose cached for this frame, so the bRelativeToHMD code paths agree with the camera
+	const FCachedPose& Pose = PrivGetCachedPose();
+	Frame.bPoseValid = Pose.bValid;
+	if (Frame.bPoseValid)
+		Frame.HMDOrientation = Pose.Transform.GetRotation();
+
+	// The gaze only ever comes from the background sampler, so building the snapshot never makes a service call on the game thread
+	// Until the sampler has a sample (eg. while the service is starting up), the previous data is kept but marked invalid
+	FFoveGazeSample Sample;
+	Frame.bGazeValid = GetLatestGazeSample(Sample);
+	if (Frame.bGazeValid)
+	{
+		Frame.LeftGaze = Sample.LeftGaze;
+		Frame.RightGaze = Sample.RightGaze;
+		Frame.FilteredLeftGaze = Sample.FilteredLeftGaze;
+		Frame.FilteredRightGaze = Sample.FilteredRightGaze;
+		if (Sample.bConvergenceValid)
+		{
+			Frame.Convergence = Sample.Convergence;
+			Frame.FilteredConvergence = Sample.FilteredConvergence;
+		}
+		if (Sample.bEyesTrackedValid)
+			Frame.EyesTracked = Sample.EyesTracked;
+		if (Sample.bEyesClosedValid)
+			Frame.EyesClosed = Sample.EyesClosed;
+	}
+
+	Frame.bConvergenceValid = Frame.bGazeValid && Sample.bConvergenceValid;
+	Frame.bEyesTrackedValid = Frame.bGazeValid && Sample.bEyesTrackedValid;
+	Frame.bEyesClosedValid = Frame.bGazeValid && Sample.bEyesClosedValid;
+
+	// The service reports the same sample until the eye tracker produces a new one
+	Frame.bIsNewSample = Frame.bGazeValid && (Frame.LeftGaze.id != PreviousLeftId || Frame.RightGaze.id != PreviousRightId);
 }
 
 #ifdef _MSC_VER
@@ -10,6 +10,9 @@
 // Fove headers
 #include "FoveTypes.h"
 
+// Plugin headers
+#include "FoveEyeTrackingComponent.h"
+
 // Make sure that we have the macros needed to specialize the build for different versions of Unreal Engine
 #if !defined(ENGINE_MAJOR_VERSION) || !defined(ENGINE_MINOR_VERSION)
 static_assert(false, "Unable to find Unreal version macros");
@@ -29,16 +32,189 @@ static_assert(false, "This version of the Fove Unreal plugin only supports Unrea
 #define FOVEHMD_BASE_CLASS IHeadMountedDisplay
 #endif
 
+// Foveated rendering (see fove.Foveation) adds views to the stereo family, which needs the view index interface added in 4.15
+// It also combines the views in RenderTexture_RenderThread, which was removed in 4.18
+#if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 15 && ENGINE_MINOR_VERSION < 18
+#define FOVEHMD_SUPPORTS_FOVEATION 1
+#else
+#define FOVEHMD_SUPPORTS_FOVEATION 0
+#endif
+
 // Forward declarations
 struct ID3D11Texture2D;
 class FoveRenderingBridge;
+class FFoveGazeSampler;
+class FFoveHealthMonitor;
+class FFoveLoadingWatchdog;
+class FPrimitiveSceneInfo;
 class IRendererModule;
+class UFoveEyeTrackingComponent;
 namespace Fove
 {
 	class IFVRHeadset;
 	class IFVRCompositor;
 }
 
+// Snapshot of the eye tracking state for a single game frame
+// This is built from the newest sample of the background gaze sampler at most once per frame, and all gaze queries on FFoveHMD read from it
+// This way, values queried by different systems within the same frame come from the same sensor sample and agree with each other
+struct FFoveGazeFrame
+{
+	// Value of GFrameCounter when this snapshot was taken
+	uint64 FrameNumber = MAX_uint64;
+
+	// Raw eye tracking data, as returned by the FOVE service
+	// The id and timestamp fields of the gaze vectors identify the sensor sample this snapshot was built from
+	Fove::SFVR_GazeVector LeftGaze;
+	Fove::SFVR_GazeVector RightGaze;
+	Fove::SFVR_GazeConvergenceData Convergence;
+	Fove::EFVR_Eye EyesTracked = Fove::EFVR_Eye::Neither;
+	Fove::EFVR_Eye EyesClosed = Fove::EFVR_Eye::Neither;
+
+	// Gaze data after the built-in gaze filter (see fove.GazeFilter). These are equal to the raw values when filtering is disabled
+	Fove::SFVR_Vec3 FilteredLeftGaze;
+	Fove::SFVR_Vec3 FilteredRightGaze;
+	Fove::SFVR_GazeConvergenceData FilteredConvergence;
+
+	// Orientation of the HMD when the snapshot was taken, used by the bRelativeToHMD code paths
+	FQuat HMDOrientation = FQuat::Identity;
+
+	// Whether each of the above pieces of data was fetched successfully
+	bool bPoseValid = false;
+	bool bGazeValid = false;
+	bool bConvergenceValid = false;
+	bool bEyesTrackedValid = false;
+	bool bEyesClosedValid = false;
+
+	// True if the gaze sample is a different one from the sample used in the previous snapshot
+	bool bIsNewSample = false;
+};
+
+// A single eye tracking sample, as captured by the background gaze sampler at the eye tracker's native rate
+struct FFoveGazeSample
+{
+	// Sequence number assigned by the sampler, starting at 1 and increasing by one for each new sample
+	uint64 Id = 0;
+
+	// Time at which the sampler picked up this sample, in FPlatformTime::Seconds()
+	double ReceiveTime = 0.0;
+
+	// Raw eye tracking data, as returned by the FOVE service
+	// The timestamp fields in these hold the time at which the eye tracker captured the sample
+	Fove::SFVR_GazeVector LeftGaze;
+	Fove::SFVR_GazeVector RightGaze;
+	Fove::SFVR_GazeConvergenceData Convergence;
+
+	// Which eyes were closed when the sample was taken
+	Fove::EFVR_Eye EyesClosed = Fove::EFVR_Eye::Neither;
+
+	// Gaze data after the built-in gaze filter (see fove.GazeFilter), which is applied once per sample by the sampler thread
+	// These are equal to the raw values when filtering is disabled
+	Fove::SFVR_Vec3 FilteredLeftGaze;
+	Fove::SFVR_Vec3 FilteredRightGaze;
+	Fove::SFVR_GazeConvergenceData FilteredConvergence;
+
+	// Which eyes were being tracked when the sample was taken
+	Fove::EFVR_Eye EyesTracked = Fove::EFVR_Eye::Neither;
+
+	// False if the convergence data, eye closure or tracking state could not be fetched for this sample
+	bool bConvergenceValid = false;
+	bool bEyesClosedValid = false;
+	bool bEyesTrackedValid = false;
+};
+
+// A blink or tracking change of one eye, detected by the background gaze sampler
+struct FFoveEyeStateEvent
+{
+	// Sequence number assigned by the sampler, starting at 1 and increasing by one for each new event
+	uint64 Id = 0;
+
+	EFoveEye Eye = EFoveEye::Left;
+	EFoveEyeStateChange Change = EFoveEyeStateChange::BlinkStarted;
+
+	// Time of the first sample showing the new state, in the eye tracker's clock (see SFVR_GazeVector::timestamp), in milliseconds
+	uint64 Timestamp = 0;
+
+	// For BlinkEnded and TrackingAcquired, how long the eye was closed or lost for, in seconds. Zero otherwise
+	float Duration = 0.0f;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnFoveEyeStateChanged, const FFoveEyeStateEvent&);
+
+// State of one part of the FOVE system, as seen by the background health monitor
+enum class EFoveConnectionState : uint8
+{
+	Disconnected, // Not plugged in, or the FOVE service could not be reached
+	Connecting,   // Present but not yet usable (starting up, asleep, or the compositor is not ready yet)
+	Ready,        // Working normally
+	Degraded,     // Present but reporting an error, or (for the eye camera) uncalibrated
+};
+
+// Health of the FOVE system, published by the background health monitor at a low rate (see fove.HealthPollInterval)
+// This is packed into a single word so that it can be read from any thread with one atomic load, see FFoveHMD::GetSystemState()
+struct FFoveSystemState
+{
+	EFoveConnectionState HMD = EFoveConnectionState::Disconnected; // The headset as a whole, which is only Ready once the compositor is also ready
+	EFoveConnectionState EyeCamera = EFoveConnectionState::Disconnected;
+	EFoveConnectionState PositionCamera = EFoveConnectionState::Disconnected;
+	EFoveConnectionState EyeLEDs = EFoveConnectionState::Disconnected;
+	EFoveConnectionState PositionLEDs = EFoveConnectionState::Disconnected;
+
+	// Incremented each time the headset becomes Ready again after having dropped out
+	uint32 ConnectionGeneration = 0;
+
+	bool IsHMDConnected() const { return HMD == EFoveConnectionState::Ready || HMD == EFoveConnectionState::Degraded; }
+
+	int32 Pack() const
+	{
+		return static_cast<int32>(HMD)
+			| static_cast<int32>(EyeCamera) << 2
+			| static_cast<int32>(PositionCamera) << 4
+			| static_cast<int32>(EyeLEDs) << 6
+			| static_cast<int32>(PositionLEDs) << 8
+			| static_cast<int32>(ConnectionGeneration & 0xFFFFF) << 10;
+	}
+
+	static FFoveSystemState Unpack(const int32 Packed)
+	{
+		FFoveSystemState State;
+		State.HMD = static_cast<EFoveConnectionState>(Packed & 3);
+		State.EyeCamera = static_cast<EFoveConnectionState>(Packed >> 2 & 3);
+		State.PositionCamera = static_cast<EFoveConnectionState>(Packed >> 4 & 3);
+		State.EyeLEDs = static_cast<EFoveConnectionState>(Packed >> 6 & 3);
+		State.PositionLEDs = static_cast<EFoveConnectionState>(Packed >> 8 & 3);
+		State.ConnectionGeneration = static_cast<uint32>(Packed) >> 10;
+		return State;
+	}
+};
+
+// Types of eye movement detected by the gaze classifier
+enum class EFoveGazeEventType : uint8
+{
+	Fixation, // The gaze rested on one point
+	Saccade,  // The gaze jumped from one point to another
+	Blink,    // Both eyes were closed
+};
+
+// An eye movement event, as emitted by the streaming gaze classifier that runs on the background gaze sampler
+struct FFoveGazeEvent
+{
+	// Sequence number assigned by the classifier, starting at 1 and increasing by one for each new event
+	uint64 Id = 0;
+
+	EFoveGazeEventType Type = EFoveGazeEventType::Fixation;
+
+	// Start and end of the event, in the eye tracker's clock (see SFVR_GazeVector::timestamp), in milliseconds
+	uint64 StartTime = 0;
+	uint64 EndTime = 0;
+
+	// Average gaze direction over the event, relative to the HMD. Not used for blinks
+	FVector Centroid = FVector::ForwardVector;
+
+	// Highest angular velocity of the gaze during the event, in degrees per second. Not used for blinks
+	float PeakVelocity = 0.0f;
+};
+
 class FOVEHMD_API FFoveHMD : public FOVEHMD_BASE_CLASS, public ISceneViewExtension, public TSharedFromThis<FFoveHMD, ESPMode::ThreadSafe>
 {
 public: // Generic
@@ -68,6 +244,10 @@ public: // General FOVE-Specific Functions
 	// Returns true if all the FOVE hardware has been started correctly
 	bool IsHardwareReady() const;
 
+	// Returns the health of the FOVE system as last seen by the background health monitor
+	// This never talks to the FOVE service, and may be called from any thread
+	FFoveSystemState GetSystemState() const;
+
 public: // Eye tracking
 
 	// Returns true if eye calibration is currently running
@@ -81,6 +261,12 @@ public: // Eye tracking
 	// Returns false if there was an error
 	bool EnsureEyeTrackingCalibration();
 
+	// Returns the eye tracking snapshot for the current frame, building it from the gaze sampler if this is the first query this frame
+	// Until the sampler has a sample, the snapshot keeps the previous data with the validity flags cleared
+	// All of the gaze helpers below read from this snapshot, so it can also be used directly to get at the raw sample ids and timestamps
+	// Must be called from the game thread
+	const FFoveGazeFrame& GetGazeFrame() const;
+
 	// Returns the convergence point of the two eye rays via any of non-null out parameters
 	// The ray returned will be one of the two eye rays
 	// The distance field is the distance along the ray to the intersection point with the other eye ray
@@ -88,13 +274,21 @@ public: // Eye tracking
 	// This functionality is considered alpha. While you should use this function for eye tracking, it's best to do a raycast in the 3D world,
 	// and only use the distance field (when available) to disambiguate between multiple hits.
 	// The coordinates used here are world coordinates with (0,0,0) at the camera point.
+	// If the built-in gaze filter is enabled (see fove.GazeFilter) the ray direction and distance are filtered
 	bool GetGazeConvergence(bool bRelativeToHMD, FVector* outRayOrigin, FVector* outRayDirection, float* outDistance, float* outAccuracy) const;
 
+	// Same as GetGazeConvergence, but always returns the unfiltered data
+	bool GetRawGazeConvergence(bool bRelativeToHMD, FVector* outRayOrigin, FVector* outRayDirection, float* outDistance, float* outAccuracy) const;
+
 	// Sets outLeft/outRight to the direction of the eye gaze for that eye, if nonnull
 	// Returns false if there's an error (output arguments will not be touched in that case)
 	// if bRelativeToHMD is true, the rotiation of the HMD will be taken into account
+	// If the built-in gaze filter is enabled (see fove.GazeFilter) the returned directions are filtered
 	bool GetGazeVector(bool bRelativeToHMD, FVector* outLeft, FVector* outRight) const;
 
+	// Same as GetGazeVector, but always returns the unfiltered data
+	bool GetRawGazeVector(bool bRelativeToHMD, FVector* outLeft, FVector* outRight) const;
+
 	// Sets outLeft/outRight to the direction of the eye gaze for that eye, if nonnull
 	// The output coordinates are in 0 to 1 coordinates, where (0, 0) is the bottom left and (1, 1) is the top right of the screen
 	// Returns false if there's an error (output arguments will not be touched in that case)
@@ -111,6 +305,66 @@ public: // Eye tracking
 	// Returns false if there's an error (output arguments will not be touched in that case)
 	bool CheckEyesClosed(bool* outLeft, bool* outRight);
 
+	// Delegate fired on the game thread at the start of each frame, once for each blink and tracking change since the last frame
+	// This is driven by the background gaze sampler, so it is cheaper than polling CheckEyesClosed/CheckEyesTracked every tick
+	FOnFoveEyeStateChanged& OnEyeStateChanged() { return EyeStateChangedDelegate; }
+
+	// The eye tracker runs faster than the game, so it is also polled at its native rate from a background thread
+	// The following functions read from the history kept by that thread. They are lock free and may be called from any thread
+
+	// Sets outSample to the most recent sample
+	// Returns false if there is no sample yet, or if the last poll of the FOVE service failed
+	bool GetLatestGazeSample(FFoveGazeSample& outSample) const;
+
+	// Appends every sample with an Id greater than SampleId to outSamples, oldest first
+	// Returns the Id of the newest sample, which can be passed back in next time to only get new samples
+	// Samples that are too old to still be in the history are skipped
+	uint64 GetGazeSamplesSince(uint64 SampleId, TArray<FFoveGazeSample>& outSamples) const;
+
+	// Appends every fixation, saccade and blink event with an Id greater than EventId to outEvents, oldest first
+	// Events are classified from the full rate sample stream, and are emitted shortly after they end
+	// Returns the Id of the newest event, which can be passed back in next time to only get new events
+	uint64 GetGazeEventsSince(uint64 EventId, TArray<FFoveGazeEvent>& outEvents) const;
+
+public: // Dynamic resolution
+
+	// Returns the fraction of each eye's half of the render target (in each dimension) that is rendered into this frame
+	// This is below 1 when dynamic resolution is enabled, in which case the eye image is rendered into the top left of its half
+	// The compositor is given the rendered sub-rect, so no reallocation of the render target happens when this changes
+	float GetEyeRenderScale() const;
+
+public: // Foveated rendering
+
+	// Returns true if this frame is rendered foveated (see fove.Foveation), and sets outInset to the part of the given eye's image
+	// that is rendered at full resolution around the gaze point, in 0 to 1 coordinates where (0, 0) is the top left of the eye
+	bool GetFoveationInset(bool bRightEye, FBox2D& outInset) const;
+
+public: // Overlay layers
+
+	// Creates a compositor layer which is drawn over the scene, and returns an id for it (or 0 on failure)
+	// The layer is created in the background once the headset is ready, and the overlay shows up from then on
+	// Draw HUD, subtitles or menus into a render target and pass it to SetOverlayLayerTexture. The compositor blends it over the scene
+	// using its alpha channel, and it is resubmitted every frame without being re-rendered, so static UI costs nothing per frame
+	// If bFixedToHMD is true, the overlay stays put on the screen (no time warp), otherwise it is time warped along with the scene
+	int32 CreateOverlayLayer(bool bFixedToHMD = true);
+
+	// Sets the render target shown on an overlay layer, and which part of it each eye sees (in 0 to 1 coordinates, where (0, 0) is the top left)
+	// The render target can be redrawn or resized whenever needed, and the overlay is hidden if it is destroyed
+	// Pass a null render target to hide the overlay. Returns false if there is no overlay with the given id
+	bool SetOverlayLayerTexture(int32 OverlayId, UTextureRenderTarget2D* RenderTarget, const FBox2D& LeftBounds = FBox2D(FVector2D(0.0f, 0.0f), FVector2D(1.0f, 1.0f)), const FBox2D& RightBounds = FBox2D(FVector2D(0.0f, 0.0f), FVector2D(1.0f, 1.0f)));
+
+public: // Eye tracking components
+
+	// Sets outTransform to the transform of one eye relative to the HMD, using this frame's gaze snapshot
+	// The location is the eye's position relative to the HMD, and the X axis of the rotation points along the eye's gaze
+	// Returns false if that eye is not tracked or is closed this frame (outTransform will not be touched in that case)
+	bool GetEyeRelativeTransform(bool bRightEye, bool bFiltered, FTransform& outTransform) const;
+
+	// Called by UFoveEyeTrackingComponent when it is registered or unregistered
+	// Registered components, and anything attached to them, get a late update to the newest eye tracking sample on the render thread
+	void RegisterEyeTrackingComponent(UFoveEyeTrackingComponent* Component);
+	void UnregisterEyeTrackingComponent(UFoveEyeTrackingComponent* Component);
+
 public: // FOVE-specific position tracking functions
 
 	// Returns true if position tracking hardware has been enabled and initialized
@@ -133,6 +387,7 @@ public: // IHeadMountedDisplay / FHeadMountedDisplayBase interface
 #endif
 
 	// 4.12 and later
+	bool OnStartGameFrame(FWorldContext& WorldContext) override;
 	bool IsHMDConnected() override;
 	bool IsHMDEnabled() const override;
 	void EnableHMD(bool allow = true) override;
@@ -195,19 +450,137 @@ public: // IStereoRendering interface
 	bool ShouldUseSeparateRenderTarget() const override;
 	void UpdateViewport(bool bUseSeparateRenderTarget, const FViewport& Viewport, SViewport*) override;
 #endif
+#if FOVEHMD_SUPPORTS_FOVEATION
+	int32 GetDesiredNumberOfViews(bool bStereoRequested) const override;
+	EStereoscopicPass GetViewPassForIndex(bool bStereoRequested, uint32 ViewIndex) const override;
+	uint32 GetViewIndexForPass(EStereoscopicPass StereoPassType) const override;
+#endif
 
 public: // ISceneViewExtension interface
 
 	void SetupViewFamily(FSceneViewFamily& InViewFamily) override;
 	void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override;
-	void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override {}
+	void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override;
 	void PreRenderView_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneView& InView) override;
 	void PreRenderViewFamily_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneViewFamily& InViewFamily) override;
 
 private: // Implementation details
 
+	struct FEyeTrackingPrimitive;
+	struct FCachedPose;
+	struct FEyeGeometry;
+
 	void PrivOrientationAndPosition(FQuat& OutOrientation, FVector& OutPosition);
+	void PrivRefreshPose() const;
+	float PrivPredictionHorizon(bool bFromLastRenderPose) const;
+	const FCachedPose& PrivGetCachedPose() const;
 	FMatrix PrivStereoProjectionMatrix(EStereoscopicPass) const;
+	const FEyeGeometry& PrivGetEyeGeometry() const;
+	void PrivRefreshGazeFrame() const;
+	bool PrivGazeConvergence(const Fove::SFVR_GazeConvergenceData& Convergence, bool bRelativeToHMD, FVector* outRayOrigin, FVector* outRayDirection, float* outDistance, float* outAccuracy) const;
+	bool PrivGazeVector(const Fove::SFVR_Vec3& Left, const Fove::SFVR_Vec3& Right, bool bRelativeToHMD, FVector* outLeft, FVector* outRight) const;
+	void PrivUpdateProjectionCache();
+	void PrivUpdateDynamicResolution_RenderThread(double WaitSeconds);
+	void PrivLateUpdateEyeTrackingComponents_RenderThread(FSceneInterface* Scene);
+	void PrivDrawMirrorRects_RenderThread(FRHICommandListImmediate& RHICmdList, FTexture2DRHIParamRef Target, bool bClear, FTexture2DRHIParamRef Source, const FBox2D* SourceUVs, const FIntRect* DestRects, int32 NumRects) const;
+	void PrivUpdateFoveation();
+	FTexture2DRHIParamRef PrivComposeFoveation_RenderThread(FRHICommandListImmediate& RHICmdList, FTexture2DRHIParamRef SrcTexture) const;
+	void PrivDispatchEyeStateEvents();
+	void PrivHandleReconnect();
+	void PrivEnqueueRenderCommand(const TFunction<void(FFoveHMD&)>& Function);
+	void PrivUpdateOverlayLayers();
+	int32 PrivAddOverlayLayer(const Fove::SFVR_CompositorLayerCreateInfo& CreateInfo);
+	static FTransform PrivEyeRelativeTransform(const Fove::SFVR_Vec3& Gaze, const FVector& EyeOffset);
+	static void PrivGatherEyeTrackingPrimitives(USceneComponent* Component, TArray<FEyeTrackingPrimitive>& Primitives);
+
+	// State of the closed loop dynamic resolution controller, see fove.DynamicResolution
+	// This is updated on the render thread after each WaitForRenderPose
+	struct FDynamicResolution
+	{
+		double LastWaitEndTime = 0.0;      // Time at which the last WaitForRenderPose returned
+		double FramePeriod = 0.0;          // Estimated compositor frame period in seconds
+		double WindowMinInterval = MAX_dbl; // Shortest interval between frames seen in the current estimation window
+		int32 WindowFrames = 0;            // Number of frames in the current estimation window
+		volatile float Scale = 1.0f;       // Current per-eye render scale, read by the game thread
+		volatile int32 PublishedFramePeriodMicros = 0; // FramePeriod in microseconds, published for the game thread
+	};
+
+	// HMD pose fetched from the FOVE service once per frame, see PrivGetCachedPose()
+	// Every game thread consumer reads from this, so they all agree on the pose within a frame
+	struct FCachedPose
+	{
+		uint64 FrameNumber = MAX_uint64; // Value of GFrameCounter when the pose was fetched
+		double Timestamp = 0.0;          // Time at which the pose was fetched, in FPlatformTime::Seconds()
+		Fove::SFVR_Pose FovePose;        // Pose as returned by the FOVE service
+		FTransform Transform;            // FovePose converted to Unreal, in world units
+		bool bValid = false;             // False if the last fetch failed
+	};
+
+	// Primitive attached to an eye tracking component, gathered on the game thread for a late update on the render thread
+	// The primitive may be removed from the scene in between, so the address of its scene index is kept as well,
+	// and the primitive is only touched if the scene still has the same primitive at that index (as MotionControllerComponent does)
+	struct FEyeTrackingPrimitive
+	{
+		const int32* IndexAddress;
+		FPrimitiveSceneInfo* SceneInfo;
+	};
+
+	// Game thread state of one eye tracking component, passed to the render thread for its late update
+	struct FEyeTrackingLateUpdate
+	{
+		bool bRightEye = false;
+		bool bFiltered = true;
+		FVector EyeOffset;                // Position of the eye relative to the HMD, in world units
+		FTransform RelativeTransform;     // Relative transform set on the game thread, which the primitives were rendered with
+		FTransform ParentToWorld;         // World transform of the component's parent
+		TArray<FEyeTrackingPrimitive> Primitives;
+	};
+
+	// Eye placement cached from the FOVE service, see PrivGetEyeGeometry()
+	// This only changes when the headset is adjusted or swapped, so it is refreshed at a low rate rather than fetched for every view
+	struct FEyeGeometry
+	{
+		double RefreshTime = 0.0; // Time of the last refresh, or 0 if it needs to be refreshed
+		float IOD = 0.064f;       // Interocular distance in meters
+		FVector EyeOffsets[2] = { FVector(0.0f, -0.032f, 0.0f), FVector(0.0f, 0.032f, 0.0f) }; // Left and right eye positions relative to the HMD, in meters
+	};
+
+	// Cached lens projection for one eye
+	// The projection only changes when the clip planes change or the headset is reconnected, so this is rebuilt only at those times
+	struct FEyeProjection
+	{
+		Fove::SFVR_ProjectionParams Raw;    // Frustum extents at a depth of 1, as reported by GetRawProjectionValues
+		Fove::SFVR_Matrix44 FoveMatrix;     // Left handed projection matrix in FOVE coordinates for the current clip planes
+		FMatrix Matrix = FMatrix::Identity; // FoveMatrix converted to Unreal, with reversed-Z near/far clip
+	};
+
+	// Foveated rendering settings for one frame, decided on the game thread in SetupViewFamily (see fove.Foveation)
+	// Each eye is rendered as a reduced resolution periphery covering the whole eye, plus a full resolution inset around the gaze point
+	struct FFoveation
+	{
+		bool bActive = false;          // Whether the inset views are added to the stereo family this frame
+		float InsetSize = 0.4f;        // Size of the inset as a fraction of the eye's image, in each dimension
+		float PeripheryScale = 0.5f;   // Resolution scale of the periphery, in each dimension, including dynamic resolution
+		FVector2D InsetCenters[2] = { FVector2D::ZeroVector, FVector2D::ZeroVector }; // Gaze point of each eye in normalized device coordinates (-1 to 1, Y up)
+
+		// Returns the part of an eye's image covered by its inset, in 0 to 1 coordinates where (0, 0) is the top left
+		FBox2D GetInsetUVs(const int32 EyeIndex) const
+		{
+			const FVector2D& Center = InsetCenters[EyeIndex];
+			return FBox2D(
+				FVector2D(Center.X - InsetSize + 1.0f, 1.0f - Center.Y - InsetSize) * 0.5f,
+				FVector2D(Center.X + InsetSize + 1.0f, 1.0f - Center.Y + InsetSize) * 0.5f);
+		}
+	};
+
+	// Overlay layer created by CreateOverlayLayer()
+	struct FOverlayLayer
+	{
+		int32 Id = 0;                                         // Id handed out by CreateOverlayLayer, which is one more than its slot in the health monitor
+		Fove::SFVR_CompositorLayer Layer;                     // The layer itself, as created by the health monitor (layerId is 0 until then)
+		TWeakObjectPtr<UTextureRenderTarget2D> RenderTarget;  // Render target shown on the layer
+		FBox2D Bounds[2];                                     // Part of the render target seen by each eye
+	};
 
 	// Number of "world" units in one meter
 	float WorldToMetersScale = 1;
@@ -228,24 +601,91 @@ private: // Implementation details
 	bool bHmdEnabled = true;
 	bool bStereoEnabled = false;
 
-	int32 WindowMirrorMode = 2;  // how to mirror the display contents to the desktop window: 0 - no mirroring, 1 - single eye, 2 - stereo pair
+	// Projection cache for the left and right eyes, see PrivUpdateProjectionCache()
+	FEyeProjection EyeProjections[2];
+	bool bProjectionCacheValid = false;
 
-	// The rendering bridge used to submit to the FOVE compositor
-	// This is a reference as a hack around sporatic build fails on 4.17+MSVC due to ~FoveRenderingBridge not being defined yet.
-	// Even though a forward declaration should be perfectly fine since ~TRefCountPtr<FoveRenderingBridge> is not instanciated until after FoveRenderingBridge is declared...
-	TRefCountPtr<FoveRenderingBridge>& Bridge;
-};
+	// IOD and eye to head offsets, only refreshed on the game thread
+	// The render thread reads its own copy, which is handed over with each view family in BeginRenderViewFamily
+	mutable FEyeGeometry EyeGeometry;
+	FEyeGeometry EyeGeometry_RenderThread;
+
+	// Overlay layers, see CreateOverlayLayer()
+	TArray<FOverlayLayer> OverlayLayers;
+
+	// Dynamic resolution controller state
+	FDynamicResolution DynamicResolution;
 
-/*
-TODO:
-Note from Unreal:
-The last comment on this file has to do with eye tracking.  While there's nothing technically wrong with your implementation, there are a few Unreal-isms that you might be able to take advantage of in order to get a more naturally integrated plugin.
+	// Region of the render target that each eye was rendered into, in 0 to 1 coordinates
+	// This is taken from the views in PreRenderViewFamily_RenderThread and is only accessed on the render thread
+	FBox2D EyeUVBounds_RenderThread[2] = { FBox2D(FVector2D(0.0f, 0.0f), FVector2D(0.5f, 1.0f)), FBox2D(FVector2D(0.5f, 0.0f), FVector2D(1.0f, 1.0f)) };
 
-Right now, you expose the eye tracking parameters to the player through some functions, which return locations and rotations.  That's useful, but for many users, especially ones that use Blueprint more extensively, it's often more natural and useful for them to think in terms of component based design.  In Unreal, you can have something called SceneComponent, which basically means something that you can add to your Actor, which has a transformation associated with it.  Most things that you can see in the game are components...meshes, sprites, etc.  You can composite them together in Actors in order to create more complex Actors, and they follow a parenting hierarchy.  Because of that, it makes it very easy to deal with them in whichever space you want...component, actor, or world space.
+	// Foveated rendering settings for the current game frame, and the render thread's copy of them, handed over in BeginRenderViewFamily
+	FFoveation Foveation;
+	FFoveation Foveation_RenderThread;
 
-For your eye tracking interface, I think it's fine to leave accessors to get the transforms directly, but you might also consider making a new class based off of SceneComponent, whose job it is to simply modify it's orientation and position to match that of the user's eyes.  That will give users something physical in the world to represent the eye position, and all their standard functions (GetComponentPosition and Orientation, GetComponentWorldOrientation, etc) will also still work.  It also lets them attach things directly to the eye, if they wanted to do a gaze cursor!  All they'd have to do is attach to the eye tracking component, and the rest would be automatically updated.
+	// Region of the render target that each eye's inset was rendered into, in 0 to 1 coordinates, and whether both were rendered this frame
+	// Like EyeUVBounds_RenderThread, these are taken from the views in PreRenderViewFamily_RenderThread
+	FBox2D InsetUVBounds_RenderThread[2];
+	bool bFoveatedFrame_RenderThread = false;
 
-In the typical set up, I'd imagine that the player would have their character actor, which would in turn have its normal camera, which gets updated by the location and orientation of the HMD.  That part works now!  To do eye tracking, all they would have to do was attach two of your new FoveEyeTrackingComponents, one for each eye, to the camera, and then everything is done!
+	// Full resolution texture that the periphery and inset of each eye are combined into before being submitted and mirrored
+	mutable FTexture2DRHIRef FoveatedTexture_RenderThread;
 
-In order to do this, I suggest looking at MotionControllerComponent, which updates its relative position and orientation constantly based on the position and orientation of the motion controller.  The same could be used for the eye tracking component.  The relative position of the component would be updated to be half of the IPD offset to the left, and the orientation would be the face-space orientation of the eye.  That's it, and it would be a very natural extension of the Unreal component system.
-*/
+	// Background thread which tracks the health of the FOVE system and creates the compositor layers, including after reconnects
+	TUniquePtr<FFoveHealthMonitor> HealthMonitor;
+
+	// Background thread which keeps the compositor fed while rendering is stalled, see fove.LoadingLayer
+	// This lives as long as the HMD when there is a rendering bridge, and submits to the overlay layer with the id LoadingLayerId
+	TUniquePtr<FFoveLoadingWatchdog> LoadingWatchdog;
+	int32 LoadingLayerId = 0;
+
+	// Connection generation that the projection and eye geometry caches were fetched for, see FFoveSystemState::ConnectionGeneration
+	uint32 ConnectionGeneration = 0;
+
+	// Revision of the compositor layers last picked up from the health monitor, see PrivHandleReconnect
+	int32 LayerRevision = 0;
+
+	// Background thread which polls the eye tracker at its native rate
+	TUniquePtr<FFoveGazeSampler> GazeSampler;
+
+	// Eye tracking snapshot for the current frame, see GetGazeFrame()
+	mutable FFoveGazeFrame GazeFrame;
+
+	// HMD pose for the current frame, see PrivGetCachedPose()
+	mutable FCachedPose CachedPose;
+
+	// Eye tracking components in the world, only accessed on the game thread
+	TArray<TWeakObjectPtr<UFoveEyeTrackingComponent>> EyeTrackingComponents;
+
+	// Blink and tracking change events, see OnEyeStateChanged()
+	FOnFoveEyeStateChanged EyeStateChangedDelegate;
+	uint64 LastEyeStateEventId = 0;
+
+	// Eye tracking components to late update, copied over from the game thread in BeginRenderViewFamily
+	TArray<FEyeTrackingLateUpdate> EyeTrackingLateUpdates_RenderThread;
+
+	// Frames seen by RenderTexture_RenderThread, used to mirror every Nth frame (see fove.MirrorInterval)
+	mutable uint32 MirrorFrameCounter_RenderThread = 0;
+
+	// Intermediate texture that reduced resolution mirrors are drawn into before being stretched over the window (see fove.MirrorScale)
+	mutable FTexture2DRHIRef MirrorTexture_RenderThread;
+
+#if ENGINE_MAJOR_VERSION >= 4 && ENGINE_MINOR_VERSION >= 16
+	// Pipeline state used by PrivDrawMirrorRects_RenderThread for one kind of render target
+	struct FMirrorPipelineState
+	{
+		EPixelFormat Format = PF_Unknown;
+		uint32 Flags = 0;
+		FGraphicsPipelineStateInitializer Initializer;
+	};
+
+	// One entry for each kind of render target drawn to, which is only rebuilt if the shaders change
+	mutable TArray<FMirrorPipelineState, TInlineAllocator<2>> MirrorPipelineStates_RenderThread;
+#endif
+
+	// The rendering bridge used to submit to the FOVE compositor
+	// This is a reference as a hack around sporatic build fails on 4.17+MSVC due to ~FoveRenderingBridge not being defined yet.
+	// Even though a forward declaration should be perfectly fine since ~TRefCountPtr<FoveRenderingBridge> is not instanciated until after FoveRenderingBridge is declared...
+	TRefCountPtr<FoveRenderingBridge>& Bridge;
+};